@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+// Reads precomputed alt allele frequencies from a whitespace separated file
+// of chromosome, position, frequency and optionally the allele number.
+// Lines starting with '#' are skipped.
+class Frequency_Reader {
+ public:
+  explicit Frequency_Reader(std::istream *frequencies)
+      : frequencies(frequencies) {
+    readline();
+  }
+  // true if the file has an entry for chrom/position, setting frequency and
+  // allele_number, which is 0 when not given
+  bool find(const std::string &chrom, uint64_t position, double *frequency,
+            int *allele_number) {
+    return find(-1, chrom, position, frequency, allele_number);
+  }
+  // chrom_id is the interned id of chrom, as in Mask_Reader::in_mask
+  bool find(int chrom_id, const std::string &chrom, uint64_t position,
+            double *frequency, int *allele_number);
+
+ private:
+  std::string chromosome = "";
+  // order of chromosome relative to the query with id query_id
+  int query_id = -1;
+  bool same_chromosome = false;
+  bool before_query = false;
+  uint64_t position;
+  double frequency;
+  int allele_number;
+  std::istream *frequencies = nullptr;
+  void readline();
+};
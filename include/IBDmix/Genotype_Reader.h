@@ -3,9 +3,13 @@
 #include <string>
 #include <vector>
 
+#include "IBDmix/Frequency_Reader.h"
 #include "IBDmix/Mask_Reader.h"
 #include "IBDmix/Sample_Mapper.h"
+#include "IBDmix/chromosome_table.h"
+#include "IBDmix/genotype_planes.h"
 #include "IBDmix/lod_calculator.h"
+#include "IBDmix/lod_type.h"
 
 constexpr unsigned char IN_MASK = 1 << 0;
 constexpr unsigned char MAF_LOW = 1 << 1;
@@ -13,20 +17,56 @@ constexpr unsigned char MAF_HIGH = 1 << 2;
 constexpr unsigned char RECOVER_2_0 = 1 << 3;
 constexpr unsigned char RECOVER_0_2 = 1 << 4;
 
+// default number of sites read by Genotype_Reader::update(Genotype_Block*)
+constexpr int GENOTYPE_BLOCK_SITES = 4096;
+// limit on the samples * sites entries of a block
+constexpr int GENOTYPE_BLOCK_ENTRIES = 1 << 22;
+
+// A block of consecutive sites.  LODs and bitmasks are stored sample major
+// so a consumer can process all sites of one sample together.  Bitmasks
+// combine the line filter and recover type of each site.
+struct Genotype_Block {
+  int capacity = 0;
+  int samples = 0;
+  int sites = 0;
+  // ids in the chromosome table of the reader
+  std::vector<int> chromosomes;
+  std::vector<uint64_t> positions;
+  std::vector<lod_t> lods;
+  std::vector<unsigned char> bitmasks;
+
+  const lod_t *getLods(int sample) const {
+    return &lods[static_cast<size_t>(sample) * capacity];
+  }
+  const unsigned char *getBitmasks(int sample) const {
+    return &bitmasks[static_cast<size_t>(sample) * capacity];
+  }
+};
+
 class Genotype_Reader {
  public:
   Genotype_Reader(std::istream *genotype, std::istream *mask = nullptr,
                   double archaic_error = 0.01, double modern_error_max = 0.002,
                   double modern_error_proportion = 2, double minesp = 1e-200,
-                  int minor_allele_cutoff = 1)
+                  int minor_allele_cutoff = 1,
+                  std::istream *frequencies = nullptr)
       : genotype(genotype),
         mask(mask),
+        frequencies(frequencies),
         calculator(archaic_error, modern_error_max, modern_error_proportion,
                    minesp),
         minor_allele_cutoff(minor_allele_cutoff) {}
 
   int initialize(std::istream &samples, std::string archaic = "");
   bool update(void);
+  // size block for the samples of this reader, with at most sites per block
+  // and fewer when many samples are selected
+  void initialize_block(Genotype_Block *block,
+                        int sites = GENOTYPE_BLOCK_SITES) const;
+  // read the next sites into an initialized block.  Returns the number of
+  // sites read, 0 at the end of the file.  The single site getters refer
+  // to the last site of the block
+  int update(Genotype_Block *block);
 
   const std::vector<std::string> &get_samples() const;
   int num_samples() const { return sample_mapper.size(); }
@@ -36,25 +76,38 @@ class Genotype_Reader {
   unsigned char getLineFilter() const { return line_filtering; }
   unsigned char getRecoverType(int index) const { return recover_type[index]; }
   double getLodScore(int index) const { return lod_scores[index]; }
+  const lod_t *getLodScores() const { return lod_scores.data(); }
   char getArchaic() const { return archaic; }
   char getAlt() const { return alt; }
   char getRef() const { return ref; }
   uint64_t getPosition() const { return position; }
   double getAlleleFrequency() const { return allele_frequency; }
   const std::string &getChromosome() const { return chromosome; }
+  // id of the chromosome in getChromosomes(), -1 before the first site
+  int getChromosomeId() const { return chromosome_id; }
+  const Chromosome_Table &getChromosomes() const { return chromosomes; }
 
  private:
   Mask_Reader mask;
+  // overrides the frequency of the selected samples when set
+  Frequency_Reader frequencies;
   Sample_Mapper sample_mapper;
   LodCalculator calculator;
 
   std::istream *genotype;
-  std::istringstream iss;
-  std::string token;
   std::string buffer;
+  // first genotype column of the current line in buffer
+  const char *genotypes = nullptr;
+  // genotypes of the selected samples
+  Genotype_Planes planes;
   std::string chromosome;
+  int chromosome_id = -1;
+  Chromosome_Table chromosomes;
   std::vector<unsigned char> recover_type;
-  std::vector<double> lod_scores;
+  // binary genotype files, see genotype_format.h
+  bool binary = false;
+  std::vector<char> packed;
+  std::vector<lod_t> lod_scores;
 
   int minor_allele_cutoff;
   unsigned char line_filtering;
@@ -63,7 +116,16 @@ class Genotype_Reader {
   char ref;
   uint64_t position;
   double allele_frequency = 0;
+  // allele_frequency is from the frequency file
+  bool external_frequency = false;
+  // allele counts of the selected samples
+  int alt_count = 0;
+  int total_count = 0;
 
+  bool read_binary_header();
+  bool read_text_line();
+  bool read_binary_line();
   bool find_frequency();
+  bool find_external_frequency(bool *select);
   void process_line_buffer(bool selected);
 };
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+
+#include "IBDmix/IBD_Stack.h"
+#include "IBDmix/lod_type.h"
+
+// Nodes of one segment stored in push order as arrays, an alternative to the
+// linked IBD_Stack and IBD_Pool.  Nodes are indices: the segment is
+// [first, next) with top at next - 1, and the node pushed after end is
+// end + 1.  Nodes after the segment are pending and join it in order with
+// advance.  Nodes no longer needed are dropped by moving the remaining ones
+// to the front of the arrays when they fill.  Short segments use arrays
+// inside the stack, longer ones share one allocation.  A run of sites
+// with 0 LOD keeps its first site as a node, the others with one bitmask
+// join a second node at the position of its last site.  The second node
+// follows a node with the same cumulative lod, so it is never the start of
+// a segment or the node after end, where its first site would be needed.
+class IBD_Array_Stack {
+ public:
+  IBD_Array_Stack() = default;
+  IBD_Array_Stack(IBD_Array_Stack &&other);
+  IBD_Array_Stack &operator=(IBD_Array_Stack &&other) = delete;
+
+  // add a pending node
+  void push(uint64_t position, lod_t lod, unsigned char bitmask) {
+    // all nodes dropped, the usual case after a region ends
+    if (first == count) first = next = end = count = 0;
+    if (count == capacity) reserve();
+    positions()[count] = position;
+    cumulative_lods()[count] = lod;
+    lods()[count] = lod;
+    sites()[count] = 1;
+    bitmasks()[count] = bitmask;
+    ++count;
+  }
+  // if a site with 0 LOD and bitmask can join the top node, the second node
+  // of a run.  Nothing may be pending
+  bool canExtend(unsigned char bitmask) const {
+    return !empty() && next >= 2 && lods()[next - 1] == 0 &&
+           lods()[next - 2] == 0 && bitmasks()[next - 1] == bitmask &&
+           sites()[next - 1] < MAX_SITES;
+  }
+  // add a site with 0 LOD to the top node, leaving its cumulative lod and
+  // whether it is end unchanged
+  void extend(uint64_t position) {
+    positions()[next - 1] = position;
+    ++sites()[next - 1];
+  }
+  bool hasPending() const { return next < count; }
+  lod_t pendingLod() const { return lods()[next]; }
+  void dropPending() { ++next, first = next; }
+  // move the next pending node to the top of the segment
+  void advance() {
+    if (empty()) {
+      end = next;
+      start_separate = false;
+      start_position = positions()[next];
+      start_lod = lods()[next];
+      cumulative_lods()[next] = start_lod;
+    } else {
+      cumulative_lods()[next] = cumulative_lods()[next - 1] + lods()[next];
+    }
+    ++next;
+  }
+
+  bool empty() const { return first == next; }
+  bool isSingleton() const { return next - first == 1 && !start_separate; }
+  // nodes in the segment, including a dropped start
+  int size() const { return next - first + start_separate; }
+
+  size_t getTop() const { return next - 1; }
+  size_t getEnd() const { return end; }
+  bool topIsEnd() const { return end == next - 1; }
+  bool topIsNewMax() const {
+    return cumulative_lods()[next - 1] >= cumulative_lods()[end];
+  }
+  bool reachedMax() const { return cumulative_lods()[next - 1] < 0; }
+  // set end to top, dropping the nodes between start and end
+  void setEnd() {
+    end = next - 1;
+    if (first < end) {
+      first = end;
+      start_separate = true;
+    }
+  }
+  // drop the segment through end, the nodes after end become pending
+  void clear() {
+    first = next = end + 1;
+    start_separate = false;
+  }
+
+  uint64_t startPosition() const { return start_position; }
+  uint64_t endPosition() const { return positions()[end]; }
+  double endLod() const { return cumulative_lods()[end]; }
+  uint64_t getPosition(size_t index) const { return positions()[index]; }
+  lod_t getLod(size_t index) const { return lods()[index]; }
+  IBD_Node getNode(size_t index) const;
+
+  void write(std::ostream &strm) const;
+
+ private:
+  static constexpr uint32_t INLINE_NODES = 4;
+  static constexpr size_t NODE_BYTES =
+      sizeof(uint64_t) + sizeof(double) + sizeof(lod_t) + sizeof(uint16_t) + 1;
+  static constexpr uint16_t MAX_SITES = UINT16_MAX;
+
+  // indices first, read for every site
+  uint32_t first = 0;
+  uint32_t next = 0;
+  uint32_t count = 0;
+  uint32_t end = 0;
+  uint32_t capacity = INLINE_NODES;
+  // start is kept here when its index is dropped, its cumulative lod is
+  // its lod
+  bool start_separate = false;
+  lod_t start_lod = 0;
+  uint64_t start_position = 0;
+  // arrays of positions, cumulative lods, lods, sites and bitmasks of
+  // capacity nodes, in inline_data or storage
+  char *data = inline_data;
+  std::unique_ptr<char[]> storage;
+  alignas(8) char inline_data[INLINE_NODES * NODE_BYTES];
+
+  uint64_t *positions() const { return reinterpret_cast<uint64_t *>(data); }
+  double *cumulative_lods() const {
+    return reinterpret_cast<double *>(positions() + capacity);
+  }
+  lod_t *lods() const {
+    return reinterpret_cast<lod_t *>(cumulative_lods() + capacity);
+  }
+  uint16_t *sites() const {
+    return reinterpret_cast<uint16_t *>(lods() + capacity);
+  }
+  unsigned char *bitmasks() const {
+    return reinterpret_cast<unsigned char *>(sites() + capacity);
+  }
+  // make room for a node, moving or growing the arrays
+  void reserve();
+};
@@ -1,6 +1,13 @@
 #pragma once
 
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
 #include <vector>
 
 #include "IBDmix/Genotype_Reader.h"
@@ -8,10 +15,18 @@
 
 class IBD_Collection {
  public:
-  explicit IBD_Collection(double threshold, bool exclusive_end = true)
-      : threshold(threshold), exclusive_end(exclusive_end) {}
+  // with several threads, block updates and purge split the samples across
+  // threads, each with its own output.  Output is merged in the
+  // order of a single thread.  Updates only visit samples with a region or
+  // a lod of at least 0, a negative lod leaves other samples unchanged
+  explicit IBD_Collection(double threshold, bool exclusive_end = true,
+                          int threads = 1)
+      : threshold(threshold), exclusive_end(exclusive_end), threads(threads) {}
+  ~IBD_Collection();
   void initialize(const Genotype_Reader &reader);
   void update(const Genotype_Reader &reader, std::ostream &output);
+  // add each site of block in order, output matches single site updates
+  void update(const Genotype_Block &block, std::ostream &output);
   void purge(std::ostream &output);
 
   enum Recorder { counts, sites, lods };
@@ -19,8 +34,47 @@ class IBD_Collection {
   void writeHeader(std::ostream &strm) const;
 
  private:
-  std::vector<IBD_Segment> IBDs;
+  // a contiguous range of samples processed by one thread
+  struct Worker {
+    int first = 0;
+    int last = 0;
+    std::ostringstream output;
+    // end of the output of each site of the block in output
+    std::vector<std::streamoff> site_ends;
+    std::exception_ptr error;
+    std::thread thread;
+    // samples with a region, sample first + i in bit i % 64 of word i / 64
+    std::vector<uint64_t> open;
+    // samples to visit at a site, as open
+    std::vector<uint64_t> visit;
+    // samples without a region by the next site of the block they join
+    std::vector<std::vector<int>> waiting;
+  };
+
   double threshold;
   bool exclusive_end;
-  IBD_Pool pool;
+  int threads;
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::vector<IBD_Segment> IBDs;
+
+  // the block of the current task, nullptr to purge
+  const Genotype_Block *task = nullptr;
+  std::mutex mutex;
+  std::condition_variable started;
+  std::condition_variable finished;
+  uint64_t generation = 0;
+  int running = 0;
+  bool stopping = false;
+
+  // add the sites of block to the samples of worker, storing the end of
+  // the output of each site in site_ends unless it is nullptr
+  void add_block(Worker *worker, const Genotype_Block &block,
+                 std::ostream &output, std::streamoff *site_ends);
+  // add sample to the waiting samples of the first site from site of block
+  // with a lod of at least 0
+  void wait(Worker *worker, const Genotype_Block &block, int sample,
+            int site);
+  void work(Worker *worker);
+  void run(Worker *worker);
+  void run_workers(const Genotype_Block *block);
 };
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+
+#include "IBDmix/lod_type.h"
+
+// Maximum scoring segment scan of one sample without recorders.  Only the
+// start, the running and maximum cumulative LODs and the end are kept, with
+// the sites after end in a tail buffer.  A site reaching a new maximum
+// empties the tail, so most sites are never stored.  When the cumulative
+// LOD drops below 0 the region through end is complete; after restart the
+// tail is added again from the buffer with advance, as IBD_Segment does
+// with the nodes after end.
+class IBD_Scan {
+ public:
+  IBD_Scan() = default;
+  IBD_Scan(IBD_Scan &&other) = default;
+
+  bool empty() const { return !open; }
+  // add a site when nothing is pending.  Returns true when the region is
+  // complete
+  bool add(uint64_t position, lod_t lod) {
+    if (!open) {
+      if (lod < 0) return false;
+      // the tail and pending sites are all used
+      tail = next = count = 0;
+      begin(position, lod);
+      return false;
+    }
+    cumulative += lod;
+    if (cumulative >= max) {
+      setEnd(position, lod);
+      tail = next = count = 0;
+      return false;
+    }
+    if (count == capacity) reserve();
+    positions()[count] = position;
+    lods()[count] = lod;
+    next = ++count;
+    return cumulative < 0;
+  }
+  bool hasPending() const { return next < count; }
+  // add the next pending site, returns true when the region is complete
+  bool advance();
+  // start a new region with the tail pending
+  void restart() {
+    open = false;
+    next = tail;
+  }
+
+  uint64_t startPosition() const { return start_position; }
+  uint64_t endPosition() const { return end_position; }
+  double endLod() const { return max; }
+  // the site after end, if any
+  bool hasTail() const { return tail < next; }
+  uint64_t tailPosition() const { return positions()[tail]; }
+  lod_t tailLod() const { return lods()[tail]; }
+
+  // sites as counted by IBD_Stack: start, end if different and the tail
+  int size() const { return open ? 1 + end_separate + next - tail : 0; }
+  // write as IBD_Stack, recalculating the cumulative LODs of the tail
+  void write(std::ostream &strm) const;
+
+ private:
+  bool open = false;
+  bool end_separate = false;
+  // buffer indices, the tail is [tail, next) and pending [next, count)
+  uint32_t tail = 0;
+  uint32_t next = 0;
+  uint32_t count = 0;
+  uint32_t capacity = 0;
+  double cumulative = 0;
+  double max = 0;
+  uint64_t start_position = 0;
+  uint64_t end_position = 0;
+  lod_t start_lod = 0;
+  lod_t end_lod = 0;
+  // positions then lods of capacity sites
+  std::unique_ptr<char[]> storage;
+
+  uint64_t *positions() const {
+    return reinterpret_cast<uint64_t *>(storage.get());
+  }
+  lod_t *lods() const {
+    return reinterpret_cast<lod_t *>(positions() + capacity);
+  }
+  void begin(uint64_t position, lod_t lod) {
+    open = true;
+    end_separate = false;
+    cumulative = max = lod;
+    start_position = end_position = position;
+    start_lod = end_lod = lod;
+  }
+  void setEnd(uint64_t position, lod_t lod) {
+    max = cumulative;
+    end_position = position;
+    end_lod = lod;
+    end_separate = true;
+  }
+  // make room for a site, moving or growing the buffer
+  void reserve();
+};
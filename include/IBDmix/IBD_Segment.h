@@ -5,35 +5,44 @@
 #include <string>
 #include <vector>
 
-#include "IBDmix/IBD_Stack.h"
+#include "IBDmix/IBD_Array_Stack.h"
+#include "IBDmix/IBD_Scan.h"
 #include "IBDmix/Segment_Recorders.h"
+#include "IBDmix/chromosome_table.h"
 
 class IBD_Segment {
  public:
-  IBD_Segment(std::string name, double threshold, IBD_Pool *pool,
-              bool exclusive_end = true);
-  ~IBD_Segment();
-  void add_lod(std::string chromosome, uint64_t position, double lod,
+  // chromosome ids passed to add_lod are names in chromosomes
+  IBD_Segment(std::string name, double threshold,
+              const Chromosome_Table *chromosomes, bool exclusive_end = true);
+  void add_lod(int chromosome, uint64_t position, double lod,
                unsigned char bitmask, std::ostream &output);
   void add_recorder(std::shared_ptr<Recorder> recorder);
   void purge(std::ostream &output);
+  // without a region, adding a negative lod does nothing
+  bool empty() const { return segment ? segment->empty() : scan.empty(); }
   int size() const;
   void write(std::ostream &strm) const;
   void writeHeader(std::ostream &strm) const;
 
  private:
-  std::string name;
+  // scan first, it is checked for every site.  Recorders need every node
+  // of a region, segment keeps them when a recorder is added
+  IBD_Scan scan;
+  std::unique_ptr<IBD_Array_Stack> segment;
+  int chromosome = -1;
+  bool exclusive_end;
   double threshold;
-  IBD_Stack segment;
-  IBD_Pool *pool;
   std::vector<std::shared_ptr<Recorder>> recorders;
-  std::string chromosome = "";
-  bool exclusive_end;
+  const Chromosome_Table *chromosomes;
+  std::string name;
 
-  void add_node(IBD_Node *node, std::ostream &output);
+  void add_scan(uint64_t position, double lod, std::ostream &output);
+  void add_pending(std::ostream &output);
+  void write_region(std::ostream &output, uint64_t start, uint64_t end,
+                    double lod);
   void initialize_stats();
-  void update_stats_recursive(const IBD_Node *node);
-  void update_stats(const IBD_Node *node);
+  void update_stats(const IBD_Node &node);
   void report_stats(std::ostream &output);
 };
 
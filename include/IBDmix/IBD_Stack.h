@@ -4,11 +4,17 @@
 #include <iostream>
 #include <vector>
 
+#include "IBDmix/lod_type.h"
+
+// ordered so single precision lods pack the node into 32 bytes.  A node can
+// be several sites with 0 LOD and one bitmask, position is the last site
 struct IBD_Node {
-  double cumulative_lod, lod;
+  double cumulative_lod;
   uint64_t position;
-  unsigned char bitmask;
   IBD_Node *next;
+  lod_t lod;
+  unsigned char bitmask;
+  uint16_t sites;
 };
 
 class IBD_Stack {
@@ -56,7 +62,7 @@ class IBD_Pool {
   explicit IBD_Pool(int initial_buffer = 1024);
   ~IBD_Pool();
 
-  IBD_Node *get_node(uint64_t position, double lod = 0,
+  IBD_Node *get_node(uint64_t position, lod_t lod = 0,
                      unsigned char bitmask = 0);
   int size() const;
   void reclaim_node(IBD_Node *node);
@@ -9,10 +9,20 @@
 class Mask_Reader {
  public:
   explicit Mask_Reader(std::istream *mask) : mask(mask) { readline(); }
-  bool in_mask(const std::string &chrom, uint64_t position);
+  bool in_mask(const std::string &chrom, uint64_t position) {
+    return in_mask(-1, chrom, position);
+  }
+  // chrom_id is the interned id of chrom, see chromosome_table.h.  Names are
+  // only compared when the id or the mask chromosome changes; a negative id
+  // always compares names
+  bool in_mask(int chrom_id, const std::string &chrom, uint64_t position);
 
  private:
   std::string chromosome = "";
+  // order of chromosome relative to the query with id query_id
+  int query_id = -1;
+  bool same_chromosome = false;
+  bool before_query = false;
   uint64_t start, end;
   std::istream *mask = nullptr;
   void readline();
@@ -16,10 +16,14 @@ class Sample_Mapper {
   int size() const { return samples.size(); }
   int getArchaicIndex() const { return archaic_index; }
   int getSample(int index) const { return sample_to_index[index]; }
+  const int *getIndices() const { return sample_to_index.data(); }
+  // true when all samples but the archaic are used, in file order
+  bool isContiguous() const { return contiguous; }
   const std::vector<std::string> &getSamples() const { return samples; }
 
  private:
   int archaic_index;
+  bool contiguous = false;
   std::vector<int> sample_to_index;
   std::vector<std::string> samples;
 
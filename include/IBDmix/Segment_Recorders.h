@@ -51,5 +51,5 @@ class LODRecorder : public Recorder {
   void report(std::ostream &output) const override;
 
  private:
-  std::vector<double> LODs;
+  std::vector<lod_t> LODs;
 };
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <zlib.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Input stream buffer which transparently decompresses gzip files.
+// BGZF files (bgzip/htslib output) are split into independent blocks which
+// are inflated on a pool of worker threads and handed back in file order.
+// Plain gzip is inflated serially and uncompressed input is passed through,
+// so the buffer can be used for any vcf regardless of compression.
+class BGZF_Streambuf : public std::streambuf {
+ public:
+  enum Format { plain, gzip, bgzf };
+
+  explicit BGZF_Streambuf(const std::string &filename, int threads = 1);
+  ~BGZF_Streambuf();
+
+  Format getFormat() const { return format; }
+  bool is_open() const { return file.is_open(); }
+  // move to a bgzf virtual offset, (block file offset << 16) | offset in
+  // the inflated block, as stored in tabix and csi indices
+  void seek(uint64_t virtual_offset);
+
+ protected:
+  int_type underflow() override;
+
+ private:
+  struct Block {
+    std::vector<char> compressed;
+    std::vector<char> data;
+    bool done = false;
+    std::string error;
+  };
+
+  std::ifstream file;
+  Format format = plain;
+  std::vector<char> buffer;
+  // bytes read while detecting the format, consumed before the file
+  std::vector<char> header;
+  size_t header_used = 0;
+
+  // plain gzip state
+  z_stream stream;
+  std::vector<char> compressed;
+  bool stream_end = false;
+
+  // bgzf state, pending blocks are kept in file order
+  unsigned int queue_depth = 1;
+  std::vector<std::unique_ptr<Block>> blocks;
+  std::vector<Block *> free_blocks;
+  std::deque<Block *> pending;
+  Block *current = nullptr;
+  bool file_end = false;
+
+  std::vector<std::thread> workers;
+  std::deque<Block *> jobs;
+  std::mutex lock;
+  std::condition_variable job_ready;
+  std::condition_variable block_done;
+  bool stopping = false;
+
+  void detect_format();
+  void drain();
+  size_t read_raw(char *destination, size_t length);
+  bool fill_plain();
+  bool fill_gzip();
+  bool fill_bgzf();
+  bool read_block(Block *block);
+  void work();
+  static void inflate_block(z_stream *strm, Block *block);
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <string>
+
+// Interned chromosome names.  Readers map each chromosome to a small id when
+// it changes, so per site code compares ids and names are only looked up
+// for output.  Ids are assigned in order of first use.  A reader thread may
+// intern while another thread looks up names of earlier ids.
+class Chromosome_Table {
+ public:
+  int intern(const std::string &name);
+  const std::string &name(int id) const;
+  int size() const;
+
+ private:
+  mutable std::mutex mutex;
+  // references to names stay valid as new names are added
+  std::deque<std::string> names;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+// Layout of the binary genotype file, written by generate_gt --format bin
+// and detected by Genotype_Reader from its first byte.  Integers are
+// little endian.
+//  header: BINARY_MAGIC, uint32 number of samples, then each sample name
+//          as a uint32 length followed by the characters
+//  chromosome record: BINARY_CHROMOSOME, uint32 length and name.  Sets
+//          the chromosome of all following sites
+//  site record: BINARY_SITE, uint64 position, ref, alt then the genotypes
+//          packed 2 bits per sample, sample i in bits 2 * (i % 4) of byte
+//          i / 4.  Values are the alt allele count, with 3 for missing.
+constexpr char BINARY_MAGIC[] = "\x89IBDGT\n\x01";
+constexpr int BINARY_MAGIC_LENGTH = 8;
+constexpr char BINARY_CHROMOSOME = 'C';
+constexpr char BINARY_SITE = 'S';
+
+inline int packed_size(int samples) { return (samples + 3) / 4; }
+
+// map genotype characters to 2 bit codes, anything unexpected is missing
+inline unsigned char pack_genotype(char genotype) {
+  return (genotype >= '0' && genotype <= '2') ? genotype - '0' : 3;
+}
+
+inline char unpack_genotype(unsigned char code) { return "0129"[code & 3]; }
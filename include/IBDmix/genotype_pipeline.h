@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+
+#include "IBDmix/Genotype_Reader.h"
+#include "IBDmix/spsc_queue.h"
+
+// sites per block and blocks in flight for Pipelined_Genotype_Reader.
+// Blocks are consumed site by site, so they are kept small
+constexpr int GENOTYPE_PIPELINE_SITES = 256;
+constexpr int GENOTYPE_PIPELINE_BLOCKS = 4;
+
+// Reads and calculates LODs of a Genotype_Reader on a background thread,
+// handing filled blocks to the consumer through an SPSC queue.
+class Pipelined_Genotype_Reader {
+ public:
+  // reader must be initialized and is only used by the background thread
+  explicit Pipelined_Genotype_Reader(
+      Genotype_Reader *reader, int block_sites = GENOTYPE_PIPELINE_SITES);
+  ~Pipelined_Genotype_Reader();
+
+  // the next block of sites, valid until the next call.  Returns nullptr
+  // at the end of the file.  Errors of the reader are rethrown here
+  const Genotype_Block *update();
+
+ private:
+  struct Batch {
+    Genotype_Block block;
+    bool last = false;
+    std::exception_ptr error;
+  };
+
+  Genotype_Reader *reader;
+  SPSC_Queue<std::unique_ptr<Batch>> full;
+  SPSC_Queue<std::unique_ptr<Batch>> empty;
+  std::unique_ptr<Batch> batch;
+  std::atomic<bool> stopping{false};
+  std::thread thread;
+
+  void read();
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "IBDmix/simd_kernels.h"
+
+// Allele counts of a set of samples.  Missing samples are not called, the
+// others add their alt alleles.
+struct Allele_Counts {
+  int called;
+  int alt;
+};
+
+// Genotypes of one site stored as bitplanes across samples, 64 samples per
+// word, with room for one extra sample while setting.  Allele counts are
+// popcounts of the planes and the genotype code of a sample is a few bit
+// selects.  See slice_genotypes for the planes.
+class Genotype_Planes {
+ public:
+  void resize(int samples);
+  int size() const { return samples; }
+
+  // set sample i from genotypes[2 * indices[i]] in the genotype file layout
+  void set(const char *genotypes, const int *indices);
+
+  // set from all samples + 1 columns of genotypes but skip, in order
+  void set_all_except(const char *genotypes, int skip);
+
+  Allele_Counts count() const;
+  // 0, 1 or 2 alt alleles, 3 for missing
+  int code(int sample) const {
+    int word = sample / 64, bit = sample % 64;
+    int alleles = ((first[word] >> bit) & 1) + ((second[word] >> bit) & 1);
+    return ((missing[word] >> bit) & 1) ? 3 : alleles;
+  }
+  // fill lods and recover_type of every sample from table
+  void fill_lods(const Genotype_Table &table, lod_t *lods,
+                 unsigned char *recover_type) const;
+
+ private:
+  int samples = 0;
+  std::vector<uint64_t> first;
+  std::vector<uint64_t> second;
+  std::vector<uint64_t> missing;
+
+  static void remove_bit(std::vector<uint64_t> *plane, int bit);
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "IBDmix/output_buffer.h"
+
+// Writers for the merged genotype file produced by generate_gt.
+// Genotypes are passed as the tab separated strings of VCF_File, the
+// archaic file first followed by each modern file.
+class Genotype_Writer {
+ public:
+  Genotype_Writer(std::ostream &output, const std::vector<std::string> &samples)
+      : output(output), samples(samples), buffer(output) {}
+  virtual ~Genotype_Writer() = default;
+
+  // write buffered output, call before closing the ostream
+  virtual void flush() { buffer.flush(); }
+
+  std::ostream &getOutput() { return output; }
+  const std::vector<std::string> &getSamples() const { return samples; }
+
+  virtual void writeHeader() = 0;
+  virtual void writeSite(const std::string &chromosome, uint64_t position,
+                         char reference, char alternative,
+                         const std::vector<const std::string *> &genotypes) = 0;
+  void writeSite(const std::string &chromosome, uint64_t position,
+                 char reference, char alternative, const std::string &archaic,
+                 const std::string &modern) {
+    writeSite(chromosome, position, reference, alternative,
+              {&archaic, &modern});
+  }
+
+ protected:
+  std::ostream &output;
+  std::vector<std::string> samples;
+  Output_Buffer buffer;
+};
+
+class Text_Genotype_Writer : public Genotype_Writer {
+ public:
+  using Genotype_Writer::Genotype_Writer;
+  using Genotype_Writer::writeSite;
+  void writeHeader() override;
+  void writeSite(const std::string &chromosome, uint64_t position,
+                 char reference, char alternative,
+                 const std::vector<const std::string *> &genotypes) override;
+};
+
+class Binary_Genotype_Writer : public Genotype_Writer {
+ public:
+  Binary_Genotype_Writer(std::ostream &output,
+                         const std::vector<std::string> &samples);
+  using Genotype_Writer::writeSite;
+  void writeHeader() override;
+  void writeSite(const std::string &chromosome, uint64_t position,
+                 char reference, char alternative,
+                 const std::vector<const std::string *> &genotypes) override;
+
+ private:
+  std::string chromosome = "";
+  std::vector<char> packed;
+
+  void write_int(uint64_t value, int bytes);
+  int pack(const std::string &genotypes, int index);
+};
@@ -1,4 +1,8 @@
+#pragma once
+
+#include <cstddef>
 #include <vector>
+
 class LodCalculator {
  public:
   LodCalculator(double archaic_error = 0.01, double modern_error_max = 0.002,
@@ -11,7 +15,17 @@ class LodCalculator {
 
   double get_modern_error(double frequency) const;
   void update_lod_cache(char archaic, double freq_b, bool selected = true);
-  double calculate_lod(char modern) const;
+  // same as update_lod_cache with freq_b = alt_count / (2 * called_count),
+  // using the lookup table when possible
+  void update_lod_cache(char archaic, int alt_count, int called_count,
+                        bool selected = true);
+  double calculate_lod(char modern) const {
+    if (modern == '9') return 0;
+    return lod_cache[modern - '0'];
+  }
+
+  // prepare the lookup table for sites with up to samples called
+  void initialize_table(int samples);
 
  private:
   double archaic_error;
@@ -19,4 +33,14 @@ class LodCalculator {
   double modern_error_proportion;
   double minesp;
   std::vector<double> lod_cache;
+
+  // LODs by allele counts.  Each row holds the sites with one called count
+  // and is filled as entries are first used.  Rows are allocated until the
+  // table reaches its memory limit, afterwards LODs are calculated directly
+  struct Table_Row {
+    std::vector<double> lods;
+    std::vector<bool> computed;
+  };
+  std::vector<Table_Row> table;
+  size_t table_bytes = 0;
 };
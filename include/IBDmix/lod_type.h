@@ -0,0 +1,10 @@
+#pragma once
+
+// Storage type of per-sample and per-site LOD scores.  Building with
+// IBDMIX_FLOAT_LODS defined stores them in single precision, halving the
+// LOD arrays.  LODs are still calculated and summed in double precision.
+#ifdef IBDMIX_FLOAT_LODS
+typedef float lod_t;
+#else
+typedef double lod_t;
+#endif
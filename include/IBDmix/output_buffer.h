@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Byte buffer in front of an ostream for writing large text outputs.
+// Values are formatted directly into the buffer, which is written with a
+// single ostream::write each time it fills.  Integers are formatted without
+// locale handling; doubles match the default ostream formatting.
+class Output_Buffer {
+ public:
+  explicit Output_Buffer(std::ostream &output, size_t capacity = 1 << 16);
+  ~Output_Buffer() { flush(); }
+
+  // write buffered bytes to the ostream
+  void flush();
+
+  void write(const char *data, size_t length) {
+    if (size + length > buffer.size()) {
+      flush();
+      // too large to buffer
+      if (length > buffer.size()) {
+        output.write(data, length);
+        return;
+      }
+    }
+    memcpy(&buffer[size], data, length);
+    size += length;
+  }
+  void put(char value) {
+    if (size == buffer.size()) flush();
+    buffer[size++] = value;
+  }
+  void write_uint(uint64_t value);
+  void write_int(int64_t value);
+  void write_double(double value);
+
+  Output_Buffer &operator<<(char value) {
+    put(value);
+    return *this;
+  }
+  Output_Buffer &operator<<(const char *value) {
+    write(value, strlen(value));
+    return *this;
+  }
+  Output_Buffer &operator<<(const std::string &value) {
+    write(value.data(), value.size());
+    return *this;
+  }
+  Output_Buffer &operator<<(double value) {
+    write_double(value);
+    return *this;
+  }
+  template <typename T>
+  typename std::enable_if<std::is_integral<T>::value, Output_Buffer &>::type
+  operator<<(T value) {
+    if (std::is_signed<T>::value)
+      write_int(value);
+    else
+      write_uint(value);
+    return *this;
+  }
+
+ private:
+  std::ostream &output;
+  std::vector<char> buffer;
+  size_t size = 0;
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+
+#include "IBDmix/lod_type.h"
+
+// Vectorized kernels for the per-sample inner loops.  Each kernel has a
+// scalar reference implementation and, on x86, SSE4.2 and/or AVX2 versions.
+// The unsuffixed function dispatches to the best version supported by the
+// running cpu; all versions produce identical results.
+
+// Decode count samples of a FORMAT=GT vcf line, each the 4 byte field
+// "a|b\t", into genotypes as the sum of alleles followed by a tab.
+// Missing calls (./.) are written as '9'.  Returns true if all samples are
+// missing.
+bool decode_gt(const char *start, char *genotypes, int count);
+bool decode_gt_scalar(const char *start, char *genotypes, int count);
+bool decode_gt_sse42(const char *start, char *genotypes, int count);
+bool decode_gt_avx2(const char *start, char *genotypes, int count);
+
+// Per sample values by genotype code, 0, 1 and 2 for the alt allele counts
+// and 3 for missing and any other character
+struct Genotype_Table {
+  lod_t lods[4];
+  unsigned char recover[4];
+};
+
+// Bitplanes of the samples at indices, sample i in bit i % 64 of word
+// i / 64.  first is set for at least one alt allele, second for two and
+// missing for anything other than 0, 1 or 2.  Bits past count are cleared.
+// genotypes is in the tab separated layout of the genotype file, a
+// character followed by a tab for each sample.  The avx2 version gathers
+// 4 bytes around each sample, so 2 bytes before the first sample must be
+// readable
+void slice_genotypes(const char *genotypes, const int *indices, int count,
+                     uint64_t *first, uint64_t *second, uint64_t *missing);
+void slice_genotypes_scalar(const char *genotypes, const int *indices,
+                            int count, uint64_t *first, uint64_t *second,
+                            uint64_t *missing);
+void slice_genotypes_avx2(const char *genotypes, const int *indices,
+                          int count, uint64_t *first, uint64_t *second,
+                          uint64_t *missing);
+
+// slice_genotypes for the first count samples
+void slice_genotypes_contiguous(const char *genotypes, int count,
+                                uint64_t *first, uint64_t *second,
+                                uint64_t *missing);
+void slice_genotypes_contiguous_scalar(const char *genotypes, int count,
+                                       uint64_t *first, uint64_t *second,
+                                       uint64_t *missing);
+void slice_genotypes_contiguous_avx2(const char *genotypes, int count,
+                                     uint64_t *first, uint64_t *second,
+                                     uint64_t *missing);
+
+// lods and recover_type of the count samples of bitplanes from
+// slice_genotypes, looked up in table in a single pass
+void fill_lods_planes(const uint64_t *first, const uint64_t *second,
+                      const uint64_t *missing, int count,
+                      const Genotype_Table &table, lod_t *lods,
+                      unsigned char *recover_type);
+void fill_lods_planes_scalar(const uint64_t *first, const uint64_t *second,
+                             const uint64_t *missing, int count,
+                             const Genotype_Table &table, lod_t *lods,
+                             unsigned char *recover_type);
+void fill_lods_planes_avx2(const uint64_t *first, const uint64_t *second,
+                           const uint64_t *missing, int count,
+                           const Genotype_Table &table, lod_t *lods,
+                           unsigned char *recover_type);
+
+// Bits of the count lods not below 0, lod i in bit i % 64 of word i / 64.
+// Bits past count are cleared
+void nonnegative_lods(const lod_t *lods, int count, uint64_t *bits);
+void nonnegative_lods_scalar(const lod_t *lods, int count, uint64_t *bits);
+void nonnegative_lods_avx2(const lod_t *lods, int count, uint64_t *bits);
+
+// index of the first of count lods not below 0, count if there is none
+int find_nonnegative_lod(const lod_t *lods, int count);
+int find_nonnegative_lod_scalar(const lod_t *lods, int count);
+int find_nonnegative_lod_avx2(const lod_t *lods, int count);
+
+// cpu feature checks, always false on non-x86 builds
+bool cpu_has_sse42();
+bool cpu_has_avx2();
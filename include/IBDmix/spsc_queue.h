@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Bounded lock-free queue for a single producer and a single consumer
+// thread.  The producer only writes tail and the consumer only writes head,
+// so acquire/release ordering on the two counters is enough.  The blocking
+// push and pop spin briefly, then sleep until the other thread pops or
+// pushes; the mutex is only taken while a thread is asleep.
+template <typename T>
+class SPSC_Queue {
+ public:
+  explicit SPSC_Queue(size_t capacity)
+      : slots(round_up(capacity)), mask(slots.size() - 1) {}
+
+  // item is moved into the queue only when there is room
+  bool try_push(T &&item) {
+    if (!push_item(&item)) return false;
+    notify();
+    return true;
+  }
+
+  bool try_pop(T *item) {
+    if (!pop_item(item)) return false;
+    notify();
+    return true;
+  }
+
+  // wait for room or an item.  Returns false if stopping is set first,
+  // call wake after setting it
+  bool push(T &&item, const std::atomic<bool> &stopping) {
+    return wait([&] { return push_item(&item); }, &stopping);
+  }
+  bool pop(T *item, const std::atomic<bool> &stopping) {
+    return wait([&] { return pop_item(item); }, &stopping);
+  }
+  void push(T &&item) {
+    wait([&] { return push_item(&item); }, nullptr);
+  }
+  void pop(T *item) {
+    wait([&] { return pop_item(item); }, nullptr);
+  }
+
+  // wake a sleeping thread to check its stopping flag
+  void wake() {
+    std::lock_guard<std::mutex> guard(lock);
+    changed.notify_all();
+  }
+
+  size_t capacity() const { return slots.size(); }
+
+ private:
+  // each counter is padded to a cache line to avoid false sharing between
+  // the threads.  Padding rather than alignas keeps the queue, and classes
+  // holding it, at the default alignment for new
+  struct Counter {
+    std::atomic<size_t> value{0};
+    char padding[64 - sizeof(std::atomic<size_t>)];
+  };
+  static constexpr int SPINS = 64;
+
+  std::vector<T> slots;
+  size_t mask;
+  Counter head;
+  Counter tail;
+  std::atomic<int> sleepers{0};
+  std::mutex lock;
+  std::condition_variable changed;
+
+  bool push_item(T *item) {
+    size_t tail_value = tail.value.load(std::memory_order_relaxed);
+    if (tail_value - head.value.load(std::memory_order_acquire) == slots.size())
+      return false;
+    slots[tail_value & mask] = std::move(*item);
+    tail.value.store(tail_value + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop_item(T *item) {
+    size_t head_value = head.value.load(std::memory_order_relaxed);
+    if (head_value == tail.value.load(std::memory_order_acquire)) return false;
+    *item = std::move(slots[head_value & mask]);
+    head.value.store(head_value + 1, std::memory_order_release);
+    return true;
+  }
+
+  // the fences order the counter updates against sleepers, so either the
+  // sleeper sees the change or the other thread sees the sleeper
+  void notify() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_relaxed) > 0) wake();
+  }
+
+  // operation is retried under the lock once asleep, so the other thread
+  // is notified after the lock is released
+  template <typename Operation>
+  bool wait(Operation operation, const std::atomic<bool> *stopping) {
+    for (int i = 0; i < SPINS; ++i) {
+      if (operation()) {
+        notify();
+        return true;
+      }
+      if (stopping != nullptr && stopping->load(std::memory_order_relaxed))
+        return false;
+      std::this_thread::yield();
+    }
+    bool result;
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      sleepers.fetch_add(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      while (!(result = operation()) &&
+             (stopping == nullptr ||
+              !stopping->load(std::memory_order_relaxed)))
+        changed.wait(guard);
+      sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+    if (result) notify();
+    return result;
+  }
+
+  static size_t round_up(size_t capacity) {
+    size_t result = 1;
+    while (result < capacity) result <<= 1;
+    return result;
+  }
+};
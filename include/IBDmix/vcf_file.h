@@ -2,14 +2,29 @@
 
 #include <cstdint>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include "IBDmix/bgzf_streambuf.h"
 
 class VCF_File {
  public:
-  VCF_File(std::istream *in_file, std::ostream &output);
+  // subset restricts the genotypes to the named samples, in file order.
+  // An empty subset keeps all samples
+  VCF_File(std::istream *in_file, std::ostream &output,
+           const std::vector<std::string> &subset = {});
+  // open filename, decompressing gzip or bgzf input in process.
+  // threads sets the number of workers inflating bgzf blocks
+  VCF_File(const std::string &filename, std::ostream &output,
+           int threads = 1, const std::vector<std::string> &subset = {});
   bool update(bool skip_non_informative = false);
   bool read_line(bool skip_non_informative = false);
+  // restrict reading to the records of chromosome region, starting at the
+  // bgzf virtual offset of its first record from a tabix or csi index
+  void seek(const std::string &region, uint64_t virtual_offset);
 
   const std::string &getBlank() const { return blank_line; }
   const std::string &getGenotypes() const { return genotypes; }
@@ -19,24 +34,38 @@ class VCF_File {
   char getReference() const { return reference; }
   char getAlternative() const { return alternative; }
   int getCount() const { return number_individuals; }
+  const std::vector<std::string> &getSamples() const { return samples; }
   bool isValid() const { return isvalid; }
+  // true if any genotype is not homozygous reference
+  bool isInformative() const { return informative(genotypes); }
+  static bool informative(const std::string &genotypes);
 
  private:
+  std::unique_ptr<BGZF_Streambuf> file_buffer;
+  std::unique_ptr<std::istream> file_stream;
   std::istream *input;
   std::string buffer;
   std::istringstream iss;
 
   std::string genotypes;
   std::string blank_line;
+  std::vector<std::string> samples;
+  // selected sample columns as runs of (first column, count)
+  std::vector<std::pair<int, int>> runs;
 
   std::string chromosome;
+  std::string region = "";
   uint64_t position;
   char reference;
   char alternative;
   int number_individuals;
   bool isvalid;
 
+  void read_header(std::ostream &output,
+                   const std::vector<std::string> &subset);
   bool simpleParse(const char *start);
-  bool complexParse(const char *start, int gtInd);
-  bool parse(const char *start, std::string format);
+  bool complexParse(const char *start, const char *line_end, int gtInd);
+  bool parse(const char *start, const char *line_end, const char *format,
+             size_t length);
+  bool parse_position(const char *start, const char *end);
 };
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <string>
+#include <vector>
+
+// Reader for tabix (.tbi) and csi indices of bgzipped vcfs.  Only the
+// location of the first record of each chromosome is retained, which is
+// enough to split a whole genome vcf into chromosomes without scanning it.
+class VCF_Index {
+ public:
+  explicit VCF_Index(const std::string &index_file);
+
+  // return the index of vcf_file (vcf_file.tbi or vcf_file.csi) or an
+  // empty string if neither exists
+  static std::string find(const std::string &vcf_file);
+
+  // chromosomes with at least one record, in file order
+  const std::vector<std::string> &getChromosomes() const {
+    return chromosomes;
+  }
+  bool contains(const std::string &chromosome) const {
+    return offsets.count(chromosome) > 0;
+  }
+  // virtual offset of the first record of chromosome
+  uint64_t getOffset(const std::string &chromosome) const;
+
+ private:
+  std::vector<std::string> chromosomes;
+  std::map<std::string, uint64_t> offsets;
+
+  void read_tabix(std::istream *input);
+  void read_csi(std::istream *input);
+  std::vector<std::string> read_names(std::istream *input);
+  void add_reference(const std::string &name, uint64_t offset);
+};
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "IBDmix/genotype_writer.h"
+#include "IBDmix/vcf_file.h"
+
+// k-way merge of the modern vcfs on position, written with the archaic vcf.
+// File is VCF_File or Pipelined_VCF_File.  Archaic sites are kept when
+// informative; cohorts without the site, on another chromosome, or with
+// mismatched alleles are written as blanks.  Modern files without
+// has_records set are only used for blanks.
+template <typename File>
+void merge_vcfs(File *archaic, const std::vector<File *> &moderns,
+                const std::vector<bool> &has_records, Genotype_Writer *output);
+
+// modern samples to keep, one name per whitespace separated field of
+// sample_file.  An empty filename keeps all samples
+std::vector<std::string> read_subset(const std::string &sample_file);
+
+// throws if a sample of subset is not in any of the modern files
+void check_subset(const std::vector<std::string> &subset,
+                  const std::vector<std::unique_ptr<VCF_File>> &moderns);
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "IBDmix/genotype_writer.h"
+#include "IBDmix/spsc_queue.h"
+#include "IBDmix/vcf_file.h"
+
+// Pipeline stages for generate_gt.  Each stage runs on its own thread and
+// hands batches of lines to the next through SPSC queues.  Emptied batches
+// are returned through a second queue so their strings are reused.
+constexpr int PIPELINE_BATCH_LINES = 256;
+constexpr int PIPELINE_BATCHES = 8;
+
+// Parses a VCF_File on a background thread.  Has the same reading
+// interface as VCF_File so it can replace it in the merge.
+class Pipelined_VCF_File {
+ public:
+  // skip_non_informative is applied to every update of file
+  Pipelined_VCF_File(VCF_File *file, bool skip_non_informative = false);
+  ~Pipelined_VCF_File();
+
+  // skip_non_informative is set for the whole file in the constructor
+  bool update(bool skip_non_informative = false);
+
+  const std::string &getBlank() const { return blank_line; }
+  const std::string &getGenotypes() const { return current().genotypes; }
+  const std::string &getChromosome() const { return current().chromosome; }
+  uint64_t getPosition() const { return current().position; }
+  char getReference() const { return current().reference; }
+  char getAlternative() const { return current().alternative; }
+  int getCount() const { return count; }
+  bool isValid() const { return current().valid; }
+  bool isInformative() const {
+    return VCF_File::informative(current().genotypes);
+  }
+
+ private:
+  struct Record {
+    std::string chromosome;
+    uint64_t position;
+    char reference;
+    char alternative;
+    bool valid;
+    std::string genotypes;
+  };
+  struct Batch {
+    std::vector<Record> records;
+    size_t size = 0;
+    bool last = false;
+    std::exception_ptr error;
+  };
+
+  VCF_File *file;
+  bool skip_non_informative;
+  std::string blank_line;
+  int count;
+
+  SPSC_Queue<std::unique_ptr<Batch>> full;
+  SPSC_Queue<std::unique_ptr<Batch>> empty;
+  std::unique_ptr<Batch> batch;
+  size_t index = 0;
+  std::atomic<bool> stopping{false};
+  std::thread reader;
+
+  const Record &current() const { return batch->records[index]; }
+  void read();
+};
+
+// Formats and writes sites on a background thread.  Sites are buffered
+// until finish is called or the writer is destroyed.
+class Pipelined_Genotype_Writer : public Genotype_Writer {
+ public:
+  explicit Pipelined_Genotype_Writer(Genotype_Writer *writer);
+  ~Pipelined_Genotype_Writer();
+
+  using Genotype_Writer::writeSite;
+  // written directly, call before the first site
+  void writeHeader() override;
+  void writeSite(const std::string &chromosome, uint64_t position,
+                 char reference, char alternative,
+                 const std::vector<const std::string *> &genotypes) override;
+  // write remaining sites and wait for the writer thread
+  void finish();
+  void flush() override { finish(); }
+
+ private:
+  struct Site {
+    std::string chromosome;
+    uint64_t position;
+    char reference;
+    char alternative;
+    std::string genotypes;
+  };
+  struct Batch {
+    std::vector<Site> sites;
+    size_t size = 0;
+    bool last = false;
+  };
+
+  Genotype_Writer *writer;
+  SPSC_Queue<std::unique_ptr<Batch>> full;
+  SPSC_Queue<std::unique_ptr<Batch>> empty;
+  std::unique_ptr<Batch> batch;
+  std::exception_ptr error;
+  std::thread thread;
+  bool finished = false;
+
+  void send(bool last);
+  void write();
+};
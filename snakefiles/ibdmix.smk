@@ -48,12 +48,13 @@ rule generate_gt:
     output:
         paths['genotype_file']
 
-    threads: 2
+    threads: 4
 
     shell:
         '{input.exe} '
-            '--archaic <(zcat -f {input.archaic}) '
-            '--modern <(zcat {input.modern}) '
+            '--archaic {input.archaic} '
+            '--modern {input.modern} '
+            '--threads {threads} '
             '--output >(gzip > {output}) '
 
 def get_ibd_input(wildcards):
@@ -86,10 +87,13 @@ rule ibdmix:
 
     params: options=get_ibd_options
 
+    threads: 4
+
     shell:
         '{input.exe} '
             '--genotype <(zcat {input.genotype}) '
             '--output >(gzip > {output}) '
+            '--threads {threads} '
             '{params.options} '
             '{config[IBDmix][options]} '
 
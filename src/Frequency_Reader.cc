@@ -0,0 +1,50 @@
+#include "IBDmix/Frequency_Reader.h"
+
+bool Frequency_Reader::find(int chrom_id, const std::string &chrom,
+                            uint64_t position, double *frequency,
+                            int *allele_number) {
+  // assume queries are sorted in same order as frequency file, as with
+  // Mask_Reader
+  if (frequencies == nullptr) return false;
+
+  for (;;) {
+    if (chrom_id < 0 || chrom_id != query_id) {
+      query_id = chrom_id;
+      same_chromosome = chrom == chromosome;
+      before_query = chromosome != "" && chromosome < chrom;
+    }
+    if (same_chromosome) {
+      if (position < this->position) {
+        return false;
+      } else if (this->position < position) {
+        readline();
+      } else {
+        *frequency = this->frequency;
+        *allele_number = this->allele_number;
+        return true;
+      }
+    } else if (before_query) {
+      readline();
+    } else {
+      return false;
+    }
+  }
+}
+
+void Frequency_Reader::readline() {
+  if (frequencies == nullptr) return;
+  query_id = -1;
+  std::string line;
+  while (std::getline(*frequencies, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream iss(line);
+    if (!(iss >> chromosome >> position >> frequency) || frequency < 0 ||
+        frequency > 1) {
+      chromosome = "";
+      throw std::invalid_argument("Unable to read frequency file " + line);
+    }
+    if (!(iss >> allele_number) || allele_number < 0) allele_number = 0;
+    return;
+  }
+  chromosome = "";
+}
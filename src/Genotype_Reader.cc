@@ -9,108 +9,280 @@
 #include <iostream>
 #include <iterator>
 #include <sstream>
+#include <stdexcept>
+
+#include "IBDmix/genotype_format.h"
+#include "IBDmix/simd_kernels.h"
+
+namespace {
+uint64_t read_binary_int(std::istream *input, int bytes) {
+  unsigned char result[8];
+  if (!input->read(reinterpret_cast<char *>(result), bytes))
+    throw std::invalid_argument("Truncated binary genotype file");
+  uint64_t value = 0;
+  for (int i = bytes - 1; i >= 0; --i) value = (value << 8) | result[i];
+  return value;
+}
+
+// expand a packed byte of 4 samples to the text layout, "g\t" per sample
+struct Unpack_Table {
+  char entries[256][8];
+  Unpack_Table() {
+    for (int byte = 0; byte < 256; ++byte)
+      for (int i = 0; i < 4; ++i) {
+        entries[byte][2 * i] = unpack_genotype(byte >> (2 * i));
+        entries[byte][2 * i + 1] = '\t';
+      }
+  }
+};
+
+const Unpack_Table unpack_table;
+}  // namespace
 
 int Genotype_Reader::initialize(std::istream &samples, std::string archaic) {
   // using samples list and header line, determine number of samples
   // and mapping from position to sample number
-  std::getline(*genotype, buffer);
+  binary = genotype->peek() ==
+           static_cast<unsigned char>(BINARY_MAGIC[0]);
+  if (binary)
+    read_binary_header();
+  else
+    std::getline(*genotype, buffer);
   std::istringstream iss(buffer);
   int result = sample_mapper.initialize(iss, samples, archaic);
 
   lod_scores.resize(result);
   recover_type.resize(result);
+  planes.resize(result);
+  calculator.initialize_table(result);
   return result;
 }
 
+bool Genotype_Reader::read_binary_header() {
+  // convert the binary header to the text header line for sample_mapper
+  char magic[BINARY_MAGIC_LENGTH];
+  if (!genotype->read(magic, BINARY_MAGIC_LENGTH) ||
+      std::string(magic, BINARY_MAGIC_LENGTH) !=
+          std::string(BINARY_MAGIC, BINARY_MAGIC_LENGTH))
+    throw std::invalid_argument("Unknown binary genotype file format");
+
+  uint64_t samples = read_binary_int(genotype, 4);
+  buffer = "chrom\tpos\tref\talt";
+  std::string name;
+  for (uint64_t i = 0; i < samples; ++i) {
+    name.resize(read_binary_int(genotype, 4));
+    if (!name.empty() && !genotype->read(&name[0], name.size()))
+      throw std::invalid_argument("Truncated binary genotype file");
+    buffer += '\t' + name;
+  }
+  packed.resize(packed_size(samples));
+  chromosome = "";
+  chromosome_id = -1;
+  return true;
+}
+
 bool Genotype_Reader::update() {
   // read next line of input file
   // update the lod_scores for reading, handling masks
-  std::getline(*genotype, buffer);
-  iss.clear();
-  iss.str(buffer);
-
-  // return false if the file is read fully
-  if (!(iss >> chromosome && iss >> position)) return false;
+  if (!(binary ? read_binary_line() : read_text_line())) return false;
 
-  iss >> token;  // ref
-  ref = token[0];
-  iss >> token;  // alt
-  alt = token[0];
   line_filtering = 0;
   // selected indicates if the line should have its lod calculated
   // set to false if one of the following occurs:
   // - in a masked region
   // - fails to meet allele cutoff
   // If selected is false, lod = 0, unless archaic = (0,2) and modern = (2,0)
-  bool selected = !mask.in_mask(chromosome, position);
+  bool selected = !mask.in_mask(chromosome_id, chromosome, position);
   if (!selected) line_filtering |= IN_MASK;
 
-  // find the 4th tab and erase from buffer
-  std::string::size_type ind = buffer.find('\t');
-  for (int i = 1; i < 4; ++i) ind = buffer.find('\t', ind + 1);
-  buffer.erase(0, ind + 1);
   process_line_buffer(selected);
   return true;
 }
 
+void Genotype_Reader::initialize_block(Genotype_Block *block,
+                                       int sites) const {
+  int samples = sample_mapper.size();
+  if (samples > 0) sites = std::min(sites, GENOTYPE_BLOCK_ENTRIES / samples);
+  sites = std::max(sites, 1);
+  block->capacity = sites;
+  block->samples = samples;
+  block->sites = 0;
+  block->chromosomes.resize(sites);
+  block->positions.resize(sites);
+  block->lods.resize(static_cast<size_t>(samples) * sites);
+  block->bitmasks.resize(static_cast<size_t>(samples) * sites);
+}
+
+int Genotype_Reader::update(Genotype_Block *block) {
+  block->sites = 0;
+  while (block->sites < block->capacity && update()) {
+    int site = block->sites++;
+    block->chromosomes[site] = chromosome_id;
+    block->positions[site] = position;
+    lod_t *lods = &block->lods[site];
+    unsigned char *bitmasks = &block->bitmasks[site];
+    for (int i = 0; i < block->samples; ++i) {
+      lods[static_cast<size_t>(i) * block->capacity] = lod_scores[i];
+      bitmasks[static_cast<size_t>(i) * block->capacity] =
+          line_filtering | recover_type[i];
+    }
+  }
+  return block->sites;
+}
+
+bool Genotype_Reader::read_text_line() {
+  // return false if the file is read fully
+  if (!std::getline(*genotype, buffer)) return false;
+
+  // split the first four columns in place, genotypes start after the
+  // 4th tab
+  const char *start = buffer.data();
+  const char *line_end = start + buffer.size();
+  const char *tabs[4];
+  for (int i = 0; i < 4; ++i) {
+    tabs[i] = static_cast<const char *>(memchr(start, '\t', line_end - start));
+    if (tabs[i] == nullptr) return false;
+    start = tabs[i] + 1;
+  }
+
+  start = buffer.data();
+  if (tabs[0] == start || tabs[1] == tabs[0] + 1) return false;
+  // intern only when the chromosome changes
+  if (chromosome.compare(0, std::string::npos, start, tabs[0] - start) != 0) {
+    chromosome.assign(start, tabs[0]);
+    chromosome_id = chromosomes.intern(chromosome);
+  }
+  uint64_t value = 0;
+  for (const char *digit = tabs[0] + 1; digit != tabs[1]; ++digit) {
+    if (*digit < '0' || *digit > '9') return false;
+    value = value * 10 + (*digit - '0');
+  }
+  position = value;
+  ref = tabs[1][1];
+  alt = tabs[2][1];
+
+  genotypes = tabs[3] + 1;
+  return true;
+}
+
+bool Genotype_Reader::read_binary_line() {
+  // chromosome records precede the first site of each chromosome
+  int record;
+  while ((record = genotype->get()) == BINARY_CHROMOSOME) {
+    chromosome.resize(read_binary_int(genotype, 4));
+    if (!chromosome.empty() &&
+        !genotype->read(&chromosome[0], chromosome.size()))
+      throw std::invalid_argument("Truncated binary genotype file");
+    chromosome_id = chromosomes.intern(chromosome);
+  }
+  if (record == std::istream::traits_type::eof()) return false;
+  if (record != BINARY_SITE)
+    throw std::invalid_argument("Unknown record in binary genotype file");
+
+  position = read_binary_int(genotype, 8);
+  ref = genotype->get();
+  alt = genotype->get();
+  if (!genotype->read(packed.data(), packed.size()))
+    throw std::invalid_argument("Truncated binary genotype file");
+
+  // unpack into the text layout used by process_line_buffer, after 2
+  // bytes of padding for slice_genotypes
+  buffer.resize(packed.size() * 8 + 2);
+  for (size_t i = 0; i < packed.size(); ++i)
+    memcpy(&buffer[i * 8 + 2],
+           unpack_table.entries[static_cast<unsigned char>(packed[i])], 8);
+  genotypes = buffer.data() + 2;
+  return true;
+}
+
 void Genotype_Reader::process_line_buffer(bool selected) {
-  // assume buffer is loaded with tab-separated character in {0, 1, 2, 9}
+  // assume genotypes is loaded with tab-separated character in {0, 1, 2, 9}
   // from a genotype file.  Using sample_mapper, fill in
   // the lod_scores array with appropriate values
 
   // throughout, *2 to skip tabs
-  archaic = buffer[sample_mapper.getArchaicIndex() * 2];
+  archaic = genotypes[sample_mapper.getArchaicIndex() * 2];
+  if (sample_mapper.isContiguous())
+    planes.set_all_except(genotypes, sample_mapper.getArchaicIndex());
+  else
+    planes.set(genotypes, sample_mapper.getIndices());
   selected &= find_frequency();
 
-  calculator.update_lod_cache(archaic, allele_frequency, selected);
-
-  for (int i = 0; i < sample_mapper.size(); i++) {
-    lod_scores[i] =
-        calculator.calculate_lod(buffer[sample_mapper.getSample(i) * 2]);
-    recover_type[i] = 0;
-  }
+  if (external_frequency)
+    calculator.update_lod_cache(archaic, allele_frequency, selected);
+  else
+    calculator.update_lod_cache(archaic, alt_count, total_count / 2,
+                                selected);
 
-  // udpate recover type
-  if (!selected && archaic == '0') {
-    for (int i = 0; i < sample_mapper.size(); i++)
-      if (buffer[sample_mapper.getSample(i) * 2] == '2')
-        recover_type[i] = RECOVER_0_2;
-  } else if (!selected && archaic == '2') {
-    for (int i = 0; i < sample_mapper.size(); i++)
-      if (buffer[sample_mapper.getSample(i) * 2] == '0')
-        recover_type[i] = RECOVER_2_0;
-  }
+  // lods and recover types by genotype, filled in one pass
+  Genotype_Table table = {{static_cast<lod_t>(calculator.calculate_lod('0')),
+                           static_cast<lod_t>(calculator.calculate_lod('1')),
+                           static_cast<lod_t>(calculator.calculate_lod('2')),
+                           0},
+                          {0, 0, 0, 0}};
+  if (!selected && archaic == '0')
+    table.recover[2] = RECOVER_0_2;
+  else if (!selected && archaic == '2')
+    table.recover[0] = RECOVER_2_0;
+  planes.fill_lods(table, lod_scores.data(), recover_type.data());
 }
 
 bool Genotype_Reader::find_frequency() {
   // determine the observed frequency of alternative alleles
   // Returns true if enough counts were observed above the cutoff value
-  int total_counts = 0;
-  double alt_counts = 0;
-  char current;
   bool select = true;
-  for (int i = 0; i < sample_mapper.size(); i++)
-    if ((current = buffer[sample_mapper.getSample(i) * 2]) != '9') {
-      total_counts += 2;
-      alt_counts += current - '0';
-    }
+  external_frequency = find_external_frequency(&select);
+  if (external_frequency) return select;
+
+  Allele_Counts counts = planes.count();
+  total_count = 2 * counts.called;
+  alt_count = counts.alt;
 
-  if (alt_counts <= minor_allele_cutoff) {  // not enough counts
+  if (alt_count <= minor_allele_cutoff) {  // not enough counts
     select = false;
     line_filtering |= MAF_LOW;
   }
-  if (total_counts - alt_counts <= minor_allele_cutoff) {  // too many
+  if (total_count - alt_count <= minor_allele_cutoff) {  // too many
     select = false;
     line_filtering |= MAF_HIGH;
   }
 
-  if (total_counts == 0)
+  if (total_count == 0)
     allele_frequency = 0;
   else
-    allele_frequency = alt_counts / total_counts;
+    allele_frequency = static_cast<double>(alt_count) / total_count;
   return select;
 }
 
+bool Genotype_Reader::find_external_frequency(bool *select) {
+  // use the frequency file entry of the site, if any.
+  // Returns false if the site is not in the file
+  int allele_number;
+  if (!frequencies.find(chromosome_id, chromosome, position, &allele_frequency,
+                        &allele_number))
+    return false;
+
+  bool low, high;
+  if (allele_number > 0) {
+    int alt = static_cast<int>(allele_frequency * allele_number + 0.5);
+    low = alt <= minor_allele_cutoff;
+    high = allele_number - alt <= minor_allele_cutoff;
+  } else {
+    // without an allele number only monomorphic sites are filtered
+    low = allele_frequency <= 0;
+    high = allele_frequency >= 1;
+  }
+  if (low) {
+    *select = false;
+    line_filtering |= MAF_LOW;
+  }
+  if (high) {
+    *select = false;
+    line_filtering |= MAF_HIGH;
+  }
+  return true;
+}
+
 const std::vector<std::string> &Genotype_Reader::get_samples() const {
   return sample_mapper.getSamples();
 }
@@ -0,0 +1,76 @@
+#include "IBDmix/IBD_Array_Stack.h"
+
+#include <string.h>
+
+IBD_Array_Stack::IBD_Array_Stack(IBD_Array_Stack &&other)
+    : first(other.first),
+      next(other.next),
+      count(other.count),
+      end(other.end),
+      capacity(other.capacity),
+      start_separate(other.start_separate),
+      start_lod(other.start_lod),
+      start_position(other.start_position),
+      storage(std::move(other.storage)) {
+  if (storage)
+    data = storage.get();
+  else
+    memcpy(inline_data, other.inline_data, sizeof(inline_data));
+  other.first = other.next = other.count = other.end = 0;
+  other.capacity = INLINE_NODES;
+  other.data = other.inline_data;
+}
+
+void IBD_Array_Stack::reserve() {
+  uint32_t kept = count - first;
+  uint64_t *old_positions = positions();
+  double *old_cumulative_lods = cumulative_lods();
+  lod_t *old_lods = lods();
+  uint16_t *old_sites = sites();
+  unsigned char *old_bitmasks = bitmasks();
+  // move within the arrays when at least half are dropped, amortized O(1)
+  std::unique_ptr<char[]> new_storage;
+  if (2 * kept > capacity) {
+    capacity *= 2;
+    new_storage.reset(new char[capacity * NODE_BYTES]);
+    data = new_storage.get();
+  }
+  // usually a few nodes, copying forward is safe when moving in place
+  for (uint32_t i = 0; i < kept; ++i) {
+    positions()[i] = old_positions[first + i];
+    cumulative_lods()[i] = old_cumulative_lods[first + i];
+    lods()[i] = old_lods[first + i];
+    sites()[i] = old_sites[first + i];
+    bitmasks()[i] = old_bitmasks[first + i];
+  }
+  if (new_storage) storage = std::move(new_storage);
+  count = kept;
+  next -= first;
+  end -= first;
+  first = 0;
+}
+
+IBD_Node IBD_Array_Stack::getNode(size_t index) const {
+  IBD_Node node;
+  node.cumulative_lod = cumulative_lods()[index];
+  node.position = positions()[index];
+  node.next = nullptr;
+  node.lod = lods()[index];
+  node.bitmask = bitmasks()[index];
+  node.sites = sites()[index];
+  return node;
+}
+
+void IBD_Array_Stack::write(std::ostream &strm) const {
+  // top first, as IBD_Stack
+  for (size_t i = next; i-- > first;) {
+    strm << positions()[i] << "\t" << lods()[i] << "\t" << cumulative_lods()[i];
+    if (i == next - 1) strm << " <- top";
+    if (i == first && !start_separate) strm << " <- start";
+    if (i == end) strm << " <- end";
+    strm << "\n";
+  }
+  if (start_separate)
+    strm << start_position << "\t" << start_lod << "\t" << start_lod
+         << " <- start\n";
+}
@@ -1,22 +1,206 @@
 #include "IBDmix/IBD_Collection.h"
 
+#include <algorithm>
+#include <string>
+
+#include "IBDmix/simd_kernels.h"
+
+IBD_Collection::~IBD_Collection() {
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    stopping = true;
+    ++generation;
+  }
+  started.notify_all();
+  for (auto &worker : workers)
+    if (worker->thread.joinable()) worker->thread.join();
+}
+
 void IBD_Collection::initialize(const Genotype_Reader &reader) {
-  IBDs.reserve(reader.get_samples().size());
-  for (auto &sample : reader.get_samples())
-    IBDs.emplace_back(sample, threshold, &pool, exclusive_end);
+  int samples = reader.get_samples().size();
+  int num_workers = std::max(1, std::min(threads, samples));
+  for (int i = 0; i < num_workers; ++i) {
+    std::unique_ptr<Worker> worker(new Worker);
+    worker->first = static_cast<int64_t>(samples) * i / num_workers;
+    worker->last = static_cast<int64_t>(samples) * (i + 1) / num_workers;
+    int words = (worker->last - worker->first + 63) / 64;
+    worker->open.assign(words, 0);
+    worker->visit.assign(words, 0);
+    workers.push_back(std::move(worker));
+  }
+
+  IBDs.reserve(samples);
+  for (auto &worker : workers)
+    for (int i = worker->first; i < worker->last; ++i)
+      IBDs.emplace_back(reader.get_samples()[i], threshold,
+                        &reader.getChromosomes(), exclusive_end);
+
+  // the calling thread runs the first worker
+  for (size_t i = 1; i < workers.size(); ++i)
+    workers[i]->thread =
+        std::thread(&IBD_Collection::work, this, workers[i].get());
 }
 
 void IBD_Collection::update(const Genotype_Reader &reader,
                             std::ostream &output) {
-  for (unsigned int i = 0; i < IBDs.size(); i++) {
-    IBDs[i].add_lod(reader.getChromosome(), reader.getPosition(),
-                    reader.getLodScore(i),
-                    reader.getLineFilter() | reader.getRecoverType(i), output);
+  int chromosome = reader.getChromosomeId();
+  uint64_t position = reader.getPosition();
+  unsigned char line_filter = reader.getLineFilter();
+  for (auto &worker : workers) {
+    // samples with a region or a lod of at least 0, in sample order
+    nonnegative_lods(reader.getLodScores() + worker->first,
+                     worker->last - worker->first, worker->visit.data());
+    for (size_t word = 0; word < worker->open.size(); ++word) {
+      uint64_t open = worker->open[word];
+      for (uint64_t bits = worker->visit[word] | open; bits != 0;
+           bits &= bits - 1) {
+        int bit = __builtin_ctzll(bits);
+        int i = worker->first + word * 64 + bit;
+        IBDs[i].add_lod(chromosome, position, reader.getLodScore(i),
+                        line_filter | reader.getRecoverType(i), output);
+        if (IBDs[i].empty())
+          open &= ~(uint64_t(1) << bit);
+        else
+          open |= uint64_t(1) << bit;
+      }
+      worker->open[word] = open;
+    }
+  }
+}
+
+void IBD_Collection::update(const Genotype_Block &block,
+                            std::ostream &output) {
+  if (workers.size() <= 1) {
+    add_block(workers[0].get(), block, output, nullptr);
+    return;
+  }
+
+  run_workers(&block);
+  // regions ending at each site in sample order, as from a single thread
+  std::vector<std::string> outputs;
+  for (auto &worker : workers) {
+    outputs.push_back(worker->output.str());
+    worker->output.str("");
+  }
+  for (int site = 0; site < block.sites; ++site) {
+    for (size_t i = 0; i < workers.size(); ++i) {
+      std::streamoff start = site == 0 ? 0 : workers[i]->site_ends[site - 1];
+      std::streamoff end = workers[i]->site_ends[site];
+      if (end > start) output.write(&outputs[i][start], end - start);
+    }
   }
 }
 
 void IBD_Collection::purge(std::ostream &output) {
-  for (unsigned int i = 0; i < IBDs.size(); i++) IBDs[i].purge(output);
+  if (workers.size() <= 1) {
+    for (unsigned int i = 0; i < IBDs.size(); i++) IBDs[i].purge(output);
+    return;
+  }
+
+  run_workers(nullptr);
+  for (auto &worker : workers) {
+    output << worker->output.str();
+    worker->output.str("");
+  }
+}
+
+void IBD_Collection::add_block(Worker *worker, const Genotype_Block &block,
+                               std::ostream &output,
+                               std::streamoff *site_ends) {
+  if (worker->waiting.size() < static_cast<size_t>(block.sites))
+    worker->waiting.resize(block.sites);
+  for (int i = worker->first; i < worker->last; ++i) {
+    int index = i - worker->first;
+    if (!(worker->open[index / 64] >> (index % 64) & 1))
+      wait(worker, block, i, 0);
+  }
+
+  for (int site = 0; site < block.sites; ++site) {
+    for (int i : worker->waiting[site]) {
+      int index = i - worker->first;
+      worker->open[index / 64] |= uint64_t(1) << (index % 64);
+    }
+    worker->waiting[site].clear();
+    // regions are written in sample order, samples joining at site have
+    // none to write
+    for (size_t word = 0; word < worker->open.size(); ++word) {
+      uint64_t open = worker->open[word];
+      for (uint64_t bits = open; bits != 0; bits &= bits - 1) {
+        int bit = __builtin_ctzll(bits);
+        int i = worker->first + word * 64 + bit;
+        IBDs[i].add_lod(block.chromosomes[site], block.positions[site],
+                        block.getLods(i)[site], block.getBitmasks(i)[site],
+                        output);
+        if (IBDs[i].empty()) {
+          open &= ~(uint64_t(1) << bit);
+          wait(worker, block, i, site + 1);
+        }
+      }
+      worker->open[word] = open;
+    }
+    if (site_ends != nullptr) site_ends[site] = output.tellp();
+  }
+}
+
+void IBD_Collection::wait(Worker *worker, const Genotype_Block &block,
+                          int sample, int site) {
+  site += find_nonnegative_lod(block.getLods(sample) + site,
+                               block.sites - site);
+  if (site < block.sites) worker->waiting[site].push_back(sample);
+}
+
+void IBD_Collection::work(Worker *worker) {
+  uint64_t seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      started.wait(lock, [&] { return generation != seen; });
+      seen = generation;
+      if (stopping) return;
+    }
+    run(worker);
+    {
+      std::lock_guard<std::mutex> guard(mutex);
+      --running;
+    }
+    finished.notify_one();
+  }
+}
+
+void IBD_Collection::run(Worker *worker) {
+  try {
+    if (task == nullptr) {
+      for (int i = worker->first; i < worker->last; ++i)
+        IBDs[i].purge(worker->output);
+      return;
+    }
+    worker->site_ends.resize(task->sites);
+    add_block(worker, *task, worker->output, worker->site_ends.data());
+  } catch (...) {
+    worker->error = std::current_exception();
+  }
+}
+
+void IBD_Collection::run_workers(const Genotype_Block *block) {
+  {
+    std::lock_guard<std::mutex> guard(mutex);
+    task = block;
+    running = workers.size() - 1;
+    ++generation;
+  }
+  started.notify_all();
+  run(workers[0].get());
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&] { return running == 0; });
+  }
+  for (auto &worker : workers) {
+    if (worker->error) {
+      std::exception_ptr error = worker->error;
+      worker->error = nullptr;
+      std::rethrow_exception(error);
+    }
+  }
 }
 
 void IBD_Collection::add_recorder(IBD_Collection::Recorder type) {
@@ -0,0 +1,71 @@
+#include "IBDmix/IBD_Scan.h"
+
+#include <utility>
+#include <vector>
+
+bool IBD_Scan::advance() {
+  uint64_t position = positions()[next];
+  lod_t lod = lods()[next];
+  ++next;
+  if (!open) {
+    // a negative first site is dropped
+    tail = next;
+    if (lod >= 0) begin(position, lod);
+    return false;
+  }
+  cumulative += lod;
+  if (cumulative >= max) {
+    setEnd(position, lod);
+    tail = next;
+    return false;
+  }
+  return cumulative < 0;
+}
+
+void IBD_Scan::reserve() {
+  uint32_t kept = count - tail;
+  uint64_t *old_positions = positions();
+  lod_t *old_lods = lods();
+  // move within the buffer when at least half is used, amortized O(1)
+  std::unique_ptr<char[]> new_storage;
+  if (capacity == 0 || 2 * kept > capacity) {
+    capacity = capacity == 0 ? 16 : 2 * capacity;
+    new_storage.reset(new char[capacity * (sizeof(uint64_t) + sizeof(lod_t))]);
+    std::swap(storage, new_storage);
+  }
+  // copying forward is safe when moving in place
+  for (uint32_t i = 0; i < kept; ++i) {
+    positions()[i] = old_positions[tail + i];
+    lods()[i] = old_lods[tail + i];
+  }
+  count = kept;
+  next -= tail;
+  tail = 0;
+}
+
+void IBD_Scan::write(std::ostream &strm) const {
+  if (!open) return;
+  // cumulative lods of the tail, summed in order as when added
+  std::vector<double> cumulative_lods(next - tail);
+  double sum = max;
+  for (uint32_t i = tail; i < next; ++i)
+    cumulative_lods[i - tail] = sum += lods()[i];
+  // top first, as IBD_Stack
+  for (uint32_t i = next; i-- > tail;) {
+    strm << positions()[i] << "\t" << lods()[i] << "\t"
+         << cumulative_lods[i - tail];
+    if (i == next - 1) strm << " <- top";
+    strm << "\n";
+  }
+  bool end_is_top = tail == next;
+  if (end_separate) {
+    strm << end_position << "\t" << end_lod << "\t" << max;
+    if (end_is_top) strm << " <- top";
+    strm << " <- end\n";
+  }
+  strm << start_position << "\t" << start_lod << "\t" << start_lod;
+  if (end_is_top && !end_separate) strm << " <- top";
+  strm << " <- start";
+  if (!end_separate) strm << " <- end";
+  strm << "\n";
+}
@@ -5,99 +5,126 @@
 #include "IBDmix/Genotype_Reader.h"
 
 IBD_Segment::IBD_Segment(std::string segment_name, double threshold,
-                         IBD_Pool *pool, bool exclusive_end)
-    : name(segment_name),
+                         const Chromosome_Table *chromosomes,
+                         bool exclusive_end)
+    : exclusive_end(exclusive_end),
       threshold(threshold),
-      pool(pool),
-      exclusive_end(exclusive_end) {}
-
-IBD_Segment::~IBD_Segment() {
-  pool->reclaim_stack(&segment);
-  for (auto &recorder : recorders) recorder.reset();
-}
+      chromosomes(chromosomes),
+      name(segment_name) {}
 
 void IBD_Segment::add_recorder(std::shared_ptr<Recorder> recorder) {
+  if (!segment) segment.reset(new IBD_Array_Stack);
   recorders.push_back(recorder);
 }
 
-void IBD_Segment::add_lod(std::string chromosome, uint64_t position, double lod,
+void IBD_Segment::add_lod(int chromosome, uint64_t position, double lod,
                           unsigned char bitmask, std::ostream &output) {
-  if (chromosome != "") this->chromosome = chromosome;
   // ignore negative lod as first entry
-  if (segment.empty() && lod < 0) {
+  if (empty() && lod < 0) {
     return;
   }
+  // regions are only written after a node is added
+  this->chromosome = chromosome;
 
-  add_node(pool->get_node(position, lod, bitmask), output);
+  if (!segment) {
+    add_scan(position, lod, output);
+    return;
+  }
+  // a site with 0 LOD cannot change the region, it joins a run on top.  It
+  // is recorded now only if the run is end, as it would be a new max
+  if (lod == 0 && segment->canExtend(bitmask)) {
+    segment->extend(position);
+    if (segment->topIsEnd()) {
+      IBD_Node node = segment->getNode(segment->getTop());
+      node.position = position;
+      node.sites = 1;
+      update_stats(node);
+    }
+    return;
+  }
+  segment->push(position, lod, bitmask);
+  add_pending(output);
 }
 
 void IBD_Segment::purge(std::ostream &output) {
-  // -1 and 0s are placeholders, the -inf forces segment to pop all
-  add_lod("", 0, -std::numeric_limits<double>::infinity(), 0, output);
+  // 0s are placeholders, the -inf forces segment to pop all
+  add_lod(chromosome, 0, -std::numeric_limits<double>::infinity(), 0, output);
 }
 
-void IBD_Segment::add_node(IBD_Node *node, std::ostream &output) {
-  if (segment.empty() && node->lod < 0) {
-    pool->reclaim_node(node);
-    return;
-  }
-  segment.push(node);
-
-  // first entry, reset counts
-  if (segment.isSingleton()) {
-    initialize_stats();
-    update_stats(node);
-    return;
+void IBD_Segment::add_scan(uint64_t position, double lod,
+                           std::ostream &output) {
+  bool complete = scan.add(position, lod);
+  while (complete) {
+    if (scan.endLod() >= threshold) {
+      uint64_t end = scan.endPosition();
+      if (exclusive_end && scan.hasTail() &&
+          scan.tailLod() != -std::numeric_limits<lod_t>::infinity())
+        end = scan.tailPosition();
+      write_region(output, scan.startPosition(), end, scan.endLod());
+    }
+    // the sites after end start a new region
+    scan.restart();
+    complete = false;
+    while (!complete && scan.hasPending()) complete = scan.advance();
   }
+}
 
-  if (segment.topIsNewMax()) {
-    // add all nodes from top to end
-    if (!recorders.empty()) update_stats_recursive(segment.getTop());
-    segment.setEnd();
-    pool->reclaim_segment(&segment);
-  }
+void IBD_Segment::add_pending(std::ostream &output) {
+  // writing a region returns the nodes after its end to pending, so they
+  // are added again in order to a new segment
+  while (segment->hasPending()) {
+    if (segment->empty() && segment->pendingLod() < 0) {
+      segment->dropPending();
+      continue;
+    }
+    segment->advance();
 
-  if (segment.reachedMax()) {
-    // write output
-    if (segment.endLod() >= threshold) {
-      uint64_t pos = segment.endPosition();
-      if (exclusive_end && !segment.isEnd(segment.getTop())) {
-        // find previous node 'above' end
-        const IBD_Node *ptr = segment.getTop();
-        while (!segment.isEnd(ptr->next)) ptr = ptr->next;
-
-        if (ptr->lod != -std::numeric_limits<double>::infinity())
-          pos = ptr->position;
-      }
-      output << name << '\t' << chromosome << '\t' << segment.startPosition()
-             << '\t' << pos << '\t' << segment.endLod();
-      report_stats(output);
-      output << '\n';
+    // first entry, reset counts
+    if (segment->isSingleton()) {
+      initialize_stats();
+      update_stats(segment->getNode(segment->getTop()));
+      continue;
     }
-    IBD_Stack unprocessed = segment.getUnprocessed();
 
-    pool->reclaim_stack(&segment);
+    if (segment->topIsNewMax()) {
+      // add all nodes after end to top
+      for (size_t i = segment->getEnd() + 1; i <= segment->getTop(); ++i)
+        update_stats(segment->getNode(i));
+      segment->setEnd();
+    }
 
-    while (!unprocessed.empty()) {
-      add_node(unprocessed.pop(), output);
+    if (segment->reachedMax()) {
+      if (segment->endLod() >= threshold) {
+        uint64_t end = segment->endPosition();
+        if (exclusive_end && !segment->topIsEnd()) {
+          // the node 'above' end
+          size_t after_end = segment->getEnd() + 1;
+          if (segment->getLod(after_end) !=
+              -std::numeric_limits<double>::infinity())
+            end = segment->getPosition(after_end);
+        }
+        write_region(output, segment->startPosition(), end,
+                     segment->endLod());
+      }
+      segment->clear();
     }
   }
 }
 
-void IBD_Segment::initialize_stats() {
-  for (auto &recorder : recorders) recorder->initializeSegment();
+void IBD_Segment::write_region(std::ostream &output, uint64_t start,
+                               uint64_t end, double lod) {
+  output << name << '\t' << chromosomes->name(chromosome) << '\t' << start
+         << '\t' << end << '\t' << lod;
+  report_stats(output);
+  output << '\n';
 }
 
-void IBD_Segment::update_stats_recursive(const IBD_Node *node) {
-  // since the list is linked in decreasing order, need to traverse in
-  // reverse via recursion
-  if (node == nullptr || segment.isEnd(node)) return;
-  update_stats_recursive(node->next);
-  update_stats(node);
+void IBD_Segment::initialize_stats() {
+  for (auto &recorder : recorders) recorder->initializeSegment();
 }
 
-void IBD_Segment::update_stats(const IBD_Node *node) {
-  for (auto &recorder : recorders) recorder->record(node);
+void IBD_Segment::update_stats(const IBD_Node &node) {
+  for (auto &recorder : recorders) recorder->record(&node);
 }
 
 void IBD_Segment::report_stats(std::ostream &output) {
@@ -110,10 +137,15 @@ void IBD_Segment::writeHeader(std::ostream &strm) const {
 
 void IBD_Segment::write(std::ostream &strm) const {
   strm << "--- " << name << " ---\n";
-  segment.write(strm);
+  if (segment)
+    segment->write(strm);
+  else
+    scan.write(strm);
 }
 
-int IBD_Segment::size(void) const { return segment.size(); }
+int IBD_Segment::size(void) const {
+  return segment ? segment->size() : scan.size();
+}
 
 std::ostream &operator<<(std::ostream &strm, const IBD_Segment &segment) {
   segment.write(strm);
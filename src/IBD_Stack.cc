@@ -119,7 +119,7 @@ IBD_Pool::~IBD_Pool() {
   alloc_ptrs.clear();
 }
 
-IBD_Node *IBD_Pool::get_node(uint64_t position, double lod,
+IBD_Node *IBD_Pool::get_node(uint64_t position, lod_t lod,
                              unsigned char bitmask) {
   if (pool.empty()) {
     allocate(buffer_size);
@@ -131,6 +131,7 @@ IBD_Node *IBD_Pool::get_node(uint64_t position, double lod,
   result->position = position;
   result->lod = lod;
   result->bitmask = bitmask;
+  result->sites = 1;
   result->cumulative_lod = lod;
   result->next = nullptr;
   return result;
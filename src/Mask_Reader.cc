@@ -1,23 +1,27 @@
 #include "IBDmix/Mask_Reader.h"
 
-bool Mask_Reader::in_mask(const std::string &chrom, uint64_t position) {
+bool Mask_Reader::in_mask(int chrom_id, const std::string &chrom,
+                          uint64_t position) {
   // test if chrom/position is in mask file
   // assume queries are sorted in same order as mask file!
   // true if position is in (start, end]
   if (mask == nullptr) return false;
 
   for (;;) {
-    if (chrom == chromosome) {
+    if (chrom_id < 0 || chrom_id != query_id) {
+      query_id = chrom_id;
+      same_chromosome = chrom == chromosome;
+      before_query = chromosome != "" && chromosome < chrom;
+    }
+    if (same_chromosome) {
       if (position <= start)
         return false;
       else if (end < position)
         readline();
       else
         return true;  // start < position <= end
-    } else if (chromosome == "") {
-      return false;
+    } else if (before_query) {
       // this assumes same order. may fail with numeric vs lexigraphic sort
-    } else if (chromosome < chrom) {
       readline();
     } else {
       return false;
@@ -27,6 +31,7 @@ bool Mask_Reader::in_mask(const std::string &chrom, uint64_t position) {
 
 void Mask_Reader::readline() {
   if (mask == nullptr) return;
+  query_id = -1;
   std::string line;
   if (std::getline(*mask, line)) {
     std::istringstream iss(line);
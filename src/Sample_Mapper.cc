@@ -15,6 +15,7 @@ void Sample_Mapper::find_archaic(const std::string &archaic) {
 
 void Sample_Mapper::map(std::vector<std::string> requested_samples) {
   // set the mapping from sample to its index in the genotype file line
+  contiguous = requested_samples.empty();
   if (requested_samples.empty()) {
     // remove archaic index
     samples.erase(samples.begin() + archaic_index);
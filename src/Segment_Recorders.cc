@@ -15,18 +15,20 @@ void CountRecorder::initializeSegment() {
 }
 
 void CountRecorder::record(const IBD_Node *node) {
+  // every site of a run has the bitmask
   unsigned char bitmask = node->bitmask;
+  int count = node->sites;
   if ((bitmask & IN_MASK) && ((bitmask & MAF_LOW) || (bitmask & MAF_HIGH)))
-    ++both;
+    both += count;
   if ((bitmask & IN_MASK) && !(bitmask & MAF_LOW) && !(bitmask & MAF_HIGH))
-    ++in_mask;
-  if (!(bitmask & IN_MASK) && (bitmask & MAF_LOW)) ++maf_low;
-  if (!(bitmask & IN_MASK) && (bitmask & MAF_HIGH)) ++maf_high;
-  if (bitmask & RECOVER_2_0) ++rec_2_0;
-  if (bitmask & RECOVER_0_2) ++rec_0_2;
-  if (node->lod < 0) ++negative_lod;
-  if (node->lod > 0) ++positive_lod;
-  ++sites;
+    in_mask += count;
+  if (!(bitmask & IN_MASK) && (bitmask & MAF_LOW)) maf_low += count;
+  if (!(bitmask & IN_MASK) && (bitmask & MAF_HIGH)) maf_high += count;
+  if (bitmask & RECOVER_2_0) rec_2_0 += count;
+  if (bitmask & RECOVER_0_2) rec_0_2 += count;
+  if (node->lod < 0) negative_lod += count;
+  if (node->lod > 0) positive_lod += count;
+  sites += count;
 }
 
 void CountRecorder::report(std::ostream &output) const {
@@ -0,0 +1,348 @@
+#include "IBDmix/bgzf_streambuf.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+namespace {
+constexpr size_t BUFFER_SIZE = 1 << 16;
+// fixed portion of the gzip header, through XLEN
+constexpr size_t GZIP_HEADER = 12;
+constexpr unsigned char GZIP_ID1 = 31;
+constexpr unsigned char GZIP_ID2 = 139;
+constexpr unsigned char FLAG_EXTRA = 1 << 2;
+
+uint32_t read_le(const char *bytes, int length) {
+  uint32_t result = 0;
+  for (int i = length - 1; i >= 0; --i)
+    result = (result << 8) | static_cast<unsigned char>(bytes[i]);
+  return result;
+}
+
+bool is_gzip(const char *bytes) {
+  return static_cast<unsigned char>(bytes[0]) == GZIP_ID1 &&
+         static_cast<unsigned char>(bytes[1]) == GZIP_ID2;
+}
+
+// find the BC subfield of a gzip extra field, returning BSIZE or -1
+int find_bsize(const char *extra, size_t length) {
+  size_t ind = 0;
+  while (ind + 4 <= length) {
+    size_t subfield_length = read_le(extra + ind + 2, 2);
+    if (extra[ind] == 'B' && extra[ind + 1] == 'C' && subfield_length == 2 &&
+        ind + 6 <= length)
+      return read_le(extra + ind + 4, 2);
+    ind += 4 + subfield_length;
+  }
+  return -1;
+}
+}  // namespace
+
+BGZF_Streambuf::BGZF_Streambuf(const std::string &filename, int threads)
+    : buffer(BUFFER_SIZE) {
+  file.open(filename, std::ios::in | std::ios::binary);
+  if (!file.is_open())
+    throw std::invalid_argument("Unable to open '" + filename + '\'');
+  memset(&stream, 0, sizeof(stream));
+  detect_format();
+
+  if (format == gzip) {
+    if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK)
+      throw std::runtime_error("Unable to initialize zlib");
+    compressed.resize(BUFFER_SIZE);
+  } else if (format == bgzf && threads <= 1) {
+    // inflate blocks inline on the reading thread
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+      throw std::runtime_error("Unable to initialize zlib");
+  } else if (format == bgzf) {
+    // keep enough blocks in flight for every worker to stay busy
+    queue_depth = 4 * threads;
+    for (int i = 0; i < threads; ++i)
+      workers.emplace_back(&BGZF_Streambuf::work, this);
+  }
+  setg(buffer.data(), buffer.data(), buffer.data());
+}
+
+BGZF_Streambuf::~BGZF_Streambuf() {
+  drain();
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stopping = true;
+  }
+  job_ready.notify_all();
+  for (auto &worker : workers) worker.join();
+  if (stream.state != Z_NULL) inflateEnd(&stream);
+}
+
+void BGZF_Streambuf::detect_format() {
+  // read enough of the first member to find a BC subfield
+  header.resize(GZIP_HEADER);
+  file.read(header.data(), GZIP_HEADER);
+  header.resize(file.gcount());
+  if (header.size() < 2 || !is_gzip(header.data())) {
+    format = plain;
+    return;
+  }
+
+  format = gzip;
+  if (header.size() < GZIP_HEADER || !(header[3] & FLAG_EXTRA)) return;
+
+  size_t extra_length = read_le(header.data() + 10, 2);
+  header.resize(GZIP_HEADER + extra_length);
+  file.read(header.data() + GZIP_HEADER, extra_length);
+  header.resize(GZIP_HEADER + file.gcount());
+  if (find_bsize(header.data() + GZIP_HEADER, header.size() - GZIP_HEADER) >=
+      0)
+    format = bgzf;
+}
+
+size_t BGZF_Streambuf::read_raw(char *destination, size_t length) {
+  size_t result = 0;
+  if (header_used < header.size()) {
+    result = std::min(length, header.size() - header_used);
+    memcpy(destination, header.data() + header_used, result);
+    header_used += result;
+  }
+  if (result < length) {
+    file.read(destination + result, length - result);
+    result += file.gcount();
+  }
+  return result;
+}
+
+BGZF_Streambuf::int_type BGZF_Streambuf::underflow() {
+  if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+
+  bool filled = false;
+  switch (format) {
+    case plain:
+      filled = fill_plain();
+      break;
+    case gzip:
+      filled = fill_gzip();
+      break;
+    case bgzf:
+      filled = fill_bgzf();
+      break;
+  }
+  if (!filled) return traits_type::eof();
+  return traits_type::to_int_type(*gptr());
+}
+
+bool BGZF_Streambuf::fill_plain() {
+  size_t length = read_raw(buffer.data(), buffer.size());
+  setg(buffer.data(), buffer.data(), buffer.data() + length);
+  return length > 0;
+}
+
+bool BGZF_Streambuf::fill_gzip() {
+  // inflate until some output is produced, handling concatenated members
+  while (!stream_end) {
+    if (stream.avail_in == 0) {
+      stream.avail_in = read_raw(compressed.data(), compressed.size());
+      stream.next_in = reinterpret_cast<Bytef *>(compressed.data());
+    }
+    stream.next_out = reinterpret_cast<Bytef *>(buffer.data());
+    stream.avail_out = buffer.size();
+
+    int status = inflate(&stream, Z_NO_FLUSH);
+    if (status == Z_STREAM_END) {
+      // another member may follow
+      if (stream.avail_in == 0 && file.peek() == EOF &&
+          header_used == header.size())
+        stream_end = true;
+      else
+        inflateReset(&stream);
+    } else if (status != Z_OK && status != Z_BUF_ERROR) {
+      throw std::invalid_argument("Ill-formed gzip file");
+    } else if (status == Z_BUF_ERROR && stream.avail_in == 0) {
+      throw std::invalid_argument("Truncated gzip file");
+    }
+
+    size_t length = buffer.size() - stream.avail_out;
+    if (length > 0) {
+      setg(buffer.data(), buffer.data(), buffer.data() + length);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool BGZF_Streambuf::read_block(Block *block) {
+  // read the next bgzf block into block->compressed.
+  // return false at end of file
+  std::vector<char> &data = block->compressed;
+  data.resize(GZIP_HEADER);
+  size_t length = read_raw(data.data(), GZIP_HEADER);
+  if (length == 0) return false;
+  if (length < GZIP_HEADER || !is_gzip(data.data()) ||
+      !(data[3] & FLAG_EXTRA))
+    throw std::invalid_argument("Ill-formed bgzf block header");
+
+  size_t extra_length = read_le(data.data() + 10, 2);
+  data.resize(GZIP_HEADER + extra_length);
+  if (read_raw(data.data() + GZIP_HEADER, extra_length) != extra_length)
+    throw std::invalid_argument("Truncated bgzf block header");
+
+  int bsize = find_bsize(data.data() + GZIP_HEADER, extra_length);
+  size_t block_size = bsize + 1;
+  if (bsize < 0 || block_size < GZIP_HEADER + extra_length + 8)
+    throw std::invalid_argument("Ill-formed bgzf block size");
+
+  size_t remaining = block_size - data.size();
+  data.resize(block_size);
+  if (read_raw(data.data() + GZIP_HEADER + extra_length, remaining) !=
+      remaining)
+    throw std::invalid_argument("Truncated bgzf block");
+  return true;
+}
+
+void BGZF_Streambuf::inflate_block(z_stream *strm, Block *block) {
+  // decompress a full bgzf block, checking size and crc
+  const std::vector<char> &input = block->compressed;
+  size_t extra_length = read_le(input.data() + 10, 2);
+  size_t offset = GZIP_HEADER + extra_length;
+  uint32_t crc = read_le(input.data() + input.size() - 8, 4);
+  uint32_t size = read_le(input.data() + input.size() - 4, 4);
+
+  block->data.resize(size);
+  block->error.clear();
+  if (size == 0) return;  // empty (eof) block
+
+  inflateReset(strm);
+  strm->next_in =
+      reinterpret_cast<Bytef *>(const_cast<char *>(input.data() + offset));
+  strm->avail_in = input.size() - offset - 8;
+  strm->next_out = reinterpret_cast<Bytef *>(block->data.data());
+  strm->avail_out = size;
+
+  if (inflate(strm, Z_FINISH) != Z_STREAM_END || strm->avail_out != 0) {
+    block->error = "Ill-formed bgzf block";
+    return;
+  }
+  if (crc32(crc32(0, Z_NULL, 0),
+            reinterpret_cast<const Bytef *>(block->data.data()),
+            size) != crc)
+    block->error = "CRC mismatch in bgzf block";
+}
+
+bool BGZF_Streambuf::fill_bgzf() {
+  if (current != nullptr) {
+    free_blocks.push_back(current);
+    current = nullptr;
+  }
+
+  for (;;) {
+    // keep the queue topped up so workers run ahead of the parser
+    while (!file_end && pending.size() < queue_depth) {
+      Block *block;
+      if (free_blocks.empty()) {
+        blocks.emplace_back(new Block());
+        block = blocks.back().get();
+      } else {
+        block = free_blocks.back();
+        free_blocks.pop_back();
+      }
+
+      if (!read_block(block)) {
+        file_end = true;
+        free_blocks.push_back(block);
+        break;
+      }
+
+      block->done = false;
+      pending.push_back(block);
+      if (workers.empty()) {
+        inflate_block(&stream, block);
+        block->done = true;
+      } else {
+        std::lock_guard<std::mutex> guard(lock);
+        jobs.push_back(block);
+        job_ready.notify_one();
+      }
+    }
+
+    if (pending.empty()) return false;
+
+    Block *block = pending.front();
+    pending.pop_front();
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      block_done.wait(guard, [block] { return block->done; });
+    }
+    if (!block->error.empty()) throw std::invalid_argument(block->error);
+
+    if (block->data.empty()) {
+      free_blocks.push_back(block);
+      continue;
+    }
+
+    current = block;
+    setg(block->data.data(), block->data.data(),
+         block->data.data() + block->data.size());
+    return true;
+  }
+}
+
+void BGZF_Streambuf::drain() {
+  // wait for blocks in flight and return them to the free list
+  while (!pending.empty()) {
+    Block *block = pending.front();
+    pending.pop_front();
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      block_done.wait(guard, [block] { return block->done; });
+    }
+    free_blocks.push_back(block);
+  }
+  if (current != nullptr) {
+    free_blocks.push_back(current);
+    current = nullptr;
+  }
+}
+
+void BGZF_Streambuf::seek(uint64_t virtual_offset) {
+  if (format != bgzf)
+    throw std::invalid_argument("Only bgzf compressed files can be indexed");
+  drain();
+  header_used = header.size();
+  file.clear();
+  file.seekg(virtual_offset >> 16);
+  file_end = false;
+  setg(buffer.data(), buffer.data(), buffer.data());
+
+  size_t block_offset = virtual_offset & 0xffff;
+  if (block_offset == 0 || !fill_bgzf()) return;
+  if (block_offset > static_cast<size_t>(egptr() - eback()))
+    throw std::invalid_argument("Invalid bgzf virtual offset");
+  setg(eback(), eback() + block_offset, egptr());
+}
+
+void BGZF_Streambuf::work() {
+  z_stream strm;
+  memset(&strm, 0, sizeof(strm));
+  inflateInit2(&strm, -MAX_WBITS);
+
+  for (;;) {
+    Block *block;
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      job_ready.wait(guard, [this] { return stopping || !jobs.empty(); });
+      if (stopping) break;
+      block = jobs.front();
+      jobs.pop_front();
+    }
+
+    inflate_block(&strm, block);
+
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      block->done = true;
+    }
+    block_done.notify_all();
+  }
+
+  inflateEnd(&strm);
+}
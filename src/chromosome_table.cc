@@ -0,0 +1,24 @@
+#include "IBDmix/chromosome_table.h"
+
+#include <stdexcept>
+
+int Chromosome_Table::intern(const std::string &name) {
+  std::lock_guard<std::mutex> guard(mutex);
+  // few chromosomes, most recent first since files are sorted
+  for (int id = names.size() - 1; id >= 0; --id)
+    if (names[id] == name) return id;
+  names.push_back(name);
+  return names.size() - 1;
+}
+
+const std::string &Chromosome_Table::name(int id) const {
+  std::lock_guard<std::mutex> guard(mutex);
+  if (id < 0 || id >= static_cast<int>(names.size()))
+    throw std::invalid_argument("Unknown chromosome id " + std::to_string(id));
+  return names[id];
+}
+
+int Chromosome_Table::size() const {
+  std::lock_guard<std::mutex> guard(mutex);
+  return names.size();
+}
@@ -1,104 +1,314 @@
+#include <unistd.h>
+
 #include <CLI/CLI.hpp>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
+#include "IBDmix/genotype_writer.h"
 #include "IBDmix/vcf_file.h"
+#include "IBDmix/vcf_index.h"
+#include "IBDmix/vcf_merge.h"
+#include "IBDmix/vcf_pipeline.h"
+
+std::unique_ptr<Genotype_Writer> make_writer(
+    const std::string &format, std::ostream &output,
+    const std::vector<std::string> &samples) {
+  if (format == "bin")
+    return std::unique_ptr<Genotype_Writer>(
+        new Binary_Genotype_Writer(output, samples));
+  return std::unique_ptr<Genotype_Writer>(
+      new Text_Genotype_Writer(output, samples));
+}
+
+std::vector<std::string> get_samples(
+    const VCF_File &archaic,
+    const std::vector<std::unique_ptr<VCF_File>> &moderns) {
+  // sample names from the vcf headers, archaic first
+  std::vector<std::string> result = archaic.getSamples();
+  for (auto &modern : moderns)
+    result.insert(result.end(), modern->getSamples().begin(),
+                  modern->getSamples().end());
+  return result;
+}
+
+std::vector<std::unique_ptr<VCF_File>> open_moderns(
+    const std::vector<std::string> &modern_files, int threads,
+    const std::vector<std::string> &subset) {
+  std::vector<std::unique_ptr<VCF_File>> result;
+  std::ostringstream names;
+  for (auto &modern_file : modern_files)
+    result.emplace_back(new VCF_File(modern_file, names, threads, subset));
+  return result;
+}
+
+template <typename File>
+std::vector<File *> pointers(const std::vector<std::unique_ptr<File>> &files) {
+  std::vector<File *> result;
+  for (auto &file : files) result.push_back(file.get());
+  return result;
+}
+
+int file_threads(int threads, int files, bool pipelined) {
+  // threads are shared between the vcfs.  Pipelined vcfs are each parsed on
+  // one of the threads, the rest inflate bgzf blocks
+  if (pipelined) threads -= files;
+  return std::max(1, threads / files);
+}
+
+std::string part_file(const std::string &outfile, const std::string &chrom) {
+  // per chromosome output, either the {chrom} pattern or a temporary file
+  std::string::size_type ind = outfile.find("{chrom}");
+  if (ind != std::string::npos)
+    return outfile.substr(0, ind) + chrom + outfile.substr(ind + 7);
+
+  if (outfile != "-") return outfile + "." + chrom + ".part";
+  const char *tmpdir = std::getenv("TMPDIR");
+  return std::string(tmpdir == nullptr ? "/tmp" : tmpdir) + "/generate_gt_" +
+         std::to_string(getpid()) + "_" + chrom + ".part";
+}
+
+void merge_indexed(const std::string &archaic_file,
+                   const std::vector<std::string> &modern_files,
+                   const std::vector<std::string> &subset,
+                   const std::string &outfile, const std::string &format,
+                   int threads, int jobs) {
+  // merge each chromosome of the modern indices on a pool of jobs threads.
+  // With {chrom} in outfile each chromosome is written to its own file,
+  // otherwise the chromosomes are concatenated in modern file order
+  VCF_Index archaic_index(VCF_Index::find(archaic_file));
+  std::vector<VCF_Index> modern_indices;
+  std::vector<std::string> chromosomes;
+  for (auto &modern_file : modern_files) {
+    modern_indices.emplace_back(VCF_Index::find(modern_file));
+    for (auto &chrom : modern_indices.back().getChromosomes())
+      if (std::find(chromosomes.begin(), chromosomes.end(), chrom) ==
+          chromosomes.end())
+        chromosomes.push_back(chrom);
+  }
+  bool split = outfile.find("{chrom}") != std::string::npos;
+  int inflaters = file_threads(threads, modern_files.size() + 1, false);
+
+  std::vector<std::string> samples;
+  {
+    std::ostringstream names;
+    VCF_File archaic(archaic_file, names);
+    auto moderns = open_moderns(modern_files, 1, subset);
+    check_subset(subset, moderns);
+    samples = get_samples(archaic, moderns);
+  }
+
+  std::vector<bool> done(chromosomes.size(), false);
+  std::mutex lock;
+  std::condition_variable chromosome_done;
+  std::exception_ptr error;
+  std::atomic<size_t> next(0);
+
+  auto write_part = [&](const std::string &chrom, const std::string &part) {
+    std::ofstream output(part, std::ios::binary);
+    if (!output) throw std::runtime_error("Unable to open " + part);
+    auto writer = make_writer(format, output, samples);
+    if (split) writer->writeHeader();
+    if (archaic_index.contains(chrom)) {
+      std::ostringstream names;
+      VCF_File archaic(archaic_file, names, inflaters);
+      archaic.seek(chrom, archaic_index.getOffset(chrom));
+      auto moderns = open_moderns(modern_files, inflaters, subset);
+      // modern files without the chromosome are only used for blanks
+      std::vector<bool> has_records;
+      for (size_t j = 0; j < moderns.size(); ++j) {
+        has_records.push_back(modern_indices[j].contains(chrom));
+        if (has_records.back())
+          moderns[j]->seek(chrom, modern_indices[j].getOffset(chrom));
+      }
+      merge_vcfs(&archaic, pointers(moderns), has_records, writer.get());
+    }
+    writer->flush();
+    output.close();
+    if (!output) throw std::runtime_error("Unable to write " + part);
+  };
+
+  auto work = [&]() {
+    for (size_t i = next++; i < chromosomes.size(); i = next++) {
+      std::string part = part_file(outfile, chromosomes[i]);
+      bool failed;
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        failed = static_cast<bool>(error);
+      }
+      // no new parts are started once a chromosome has failed
+      try {
+        if (!failed) write_part(chromosomes[i], part);
+      } catch (...) {
+        // incomplete parts are never kept
+        std::remove(part.c_str());
+        std::lock_guard<std::mutex> guard(lock);
+        if (!error) error = std::current_exception();
+      }
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        done[i] = true;
+      }
+      chromosome_done.notify_all();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  size_t num_workers = std::min<size_t>(std::max(jobs, 1), chromosomes.size());
+  for (size_t i = 0; i < num_workers; ++i) workers.emplace_back(work);
+
+  if (!split) {
+    // append parts in order as they finish
+    std::ofstream of;
+    std::streambuf *buf;
+    if (outfile == "-") {
+      buf = std::cout.rdbuf();
+    } else {
+      of.open(outfile, std::ios::binary);
+      buf = of.rdbuf();
+    }
+    std::ostream output(buf);
+    make_writer(format, output, samples)->writeHeader();
+
+    for (size_t i = 0; i < chromosomes.size(); ++i) {
+      bool failed;
+      {
+        std::unique_lock<std::mutex> guard(lock);
+        chromosome_done.wait(guard, [&done, i] { return done[i]; });
+        failed = static_cast<bool>(error);
+      }
+      std::string part = part_file(outfile, chromosomes[i]);
+      {
+        std::ifstream input(part, std::ios::binary);
+        if (!failed && input.peek() != std::ifstream::traits_type::eof())
+          output << input.rdbuf();
+      }
+      std::remove(part.c_str());
+      // the remaining parts are still removed as they finish
+      if (!failed && !output.flush()) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!error)
+          error = std::make_exception_ptr(
+              std::runtime_error("Unable to write " + outfile));
+      }
+    }
+  }
+
+  for (auto &worker : workers) worker.join();
+  if (error) std::rethrow_exception(error);
+}
 
 int main(int argc, char *argv[]) {
   CLI::App app{"Produce genotype files from vcfs"};
 
   std::string archaic_file;
-  app.add_option("-a,--archaic", archaic_file, "The archaic sample vcf")
+  app.add_option("-a,--archaic", archaic_file,
+                 "The archaic sample vcf, may be gzip or bgzip compressed")
       ->check(CLI::ExistingFile)
       ->required();
 
-  std::string modern_file;
-  app.add_option("-m,--modern", modern_file, "The modern sample vcf")
+  std::vector<std::string> modern_files;
+  app.add_option("-m,--modern", modern_files,
+                 "The modern sample vcfs, may be gzip or bgzip compressed.  "
+                 "Multiple vcfs are merged on position")
       ->check(CLI::ExistingFile)
       ->required();
 
+  std::string sample_file = "";
+  app.add_option("-s,--sample", sample_file,
+                 "File containing modern samples to keep.  Default to all "
+                 "samples in the modern vcfs")
+      ->check(CLI::ExistingFile);
+
   std::string outfile = "-";
-  app.add_option("-o,--output", outfile, "The output file location");
+  app.add_option("-o,--output", outfile,
+                 "The output file location.  With indexed vcfs, {chrom} "
+                 "will write each chromosome to a separate file");
+
+  int threads = 1;
+  app.add_option("-t,--threads", threads,
+                 "Number of threads reading the vcfs, shared between the "
+                 "files.  With more than one, each vcf is parsed and the "
+                 "output is written on separate threads");
+
+  int jobs = 1;
+  app.add_option("-j,--jobs", jobs,
+                 "Number of chromosomes to merge in parallel when both vcfs "
+                 "are bgzipped with a tabix or csi index");
+
+  std::string format = "text";
+  app.add_option("-f,--format", format,
+                 "Output format, tab separated text or packed binary")
+      ->check(CLI::IsMember({"text", "bin"}));
 
   CLI11_PARSE(app, argc, argv);
 
-  std::ofstream of;
-  std::streambuf *buf;
-  if (outfile == "-") {
-    buf = std::cout.rdbuf();
-  } else {
-    of.open(outfile);
-    buf = of.rdbuf();
-  }
-  std::ostream output(buf);
-
-  std::ifstream archaic_vcf, modern_vcf;
-  archaic_vcf.open(archaic_file);
-  modern_vcf.open(modern_file);
-
-  // write header
-  output << "chrom\tpos\tref\talt";
-  // build files, this will print the headers as well (archaic first)
-  VCF_File archaic(&archaic_vcf, output);
-  VCF_File modern(&modern_vcf, output);
-  // terminate header
-  output << "\n";
-
-  bool recheck = false;
-  // for each line in modern
-  while (modern.update()) {
-    // short update with recheck for case when archaic position is > modern
-    while (recheck || archaic.update(true)) {
-      recheck = false;
-
-      // less than position, copy archaic and use modern blank line
-      if (archaic.getPosition() < modern.getPosition()) {
-        // skip lines with no informative archaic GT
-        bool nonzero = false;
-        auto gen = archaic.getGenotypes();
-        for (int i = 0; i < 2 * archaic.getCount(); i += 2)
-          if (gen[i] != '0') {
-            nonzero = true;
-            break;
-          }
-
-        // found at least one informative archaic site
-        if (nonzero) {
-          // output archaic information and blank modern
-          output << archaic.getChromosome() << '\t' << archaic.getPosition()
-                 << '\t' << archaic.getReference() << '\t'
-                 << archaic.getAlternative() << '\t';
-          output << archaic.getGenotypes();
-          output << modern.getBlank();
-          output << "\n";
-        }
-        // equal, have to check other conditions to write
-      } else if (archaic.getPosition() == modern.getPosition()) {
-        // check alleles are matching
-        if (modern.isValid() &&
-            archaic.getReference() == modern.getReference() &&
-            (archaic.getAlternative() == '.' ||
-             archaic.getAlternative() == modern.getAlternative())) {
-          output << archaic.getChromosome() << '\t' << archaic.getPosition()
-                 << '\t' << archaic.getReference() << '\t'
-                 << modern.getAlternative() << '\t';
-          output << archaic.getGenotypes();
-          output << modern.getGenotypes();
-          output << "\n";
-        }
-        // advance both to match legacy version
-        break;
-        // greater than, advance modern but keep archaic where it is
-      } else {
-        recheck = true;
-        break;
-      }
+  try {
+    std::vector<std::string> subset = read_subset(sample_file);
+
+    // whole genome vcfs are split into chromosomes with their indices
+    bool indexed = !VCF_Index::find(archaic_file).empty();
+    for (auto &modern_file : modern_files)
+      indexed &= !VCF_Index::find(modern_file).empty();
+    if (indexed) {
+      merge_indexed(archaic_file, modern_files, subset, outfile, format,
+                    threads, jobs);
+      return 0;
     }
-  }
 
-  if (of.is_open()) of.close();
-  archaic_vcf.close();
-  modern_vcf.close();
+    std::ofstream of;
+    std::streambuf *buf;
+    if (outfile == "-") {
+      buf = std::cout.rdbuf();
+    } else {
+      of.open(outfile, std::ios::binary);
+      buf = of.rdbuf();
+    }
+    std::ostream output(buf);
+
+    // build files, archaic samples are written first
+    std::ostringstream names;
+    bool pipelined = threads > 1;
+    int inflaters = file_threads(threads, modern_files.size() + 1, pipelined);
+    VCF_File archaic(archaic_file, names, inflaters);
+    auto moderns = open_moderns(modern_files, inflaters, subset);
+    check_subset(subset, moderns);
+
+    auto writer = make_writer(format, output, get_samples(archaic, moderns));
+    writer->writeHeader();
+
+    std::vector<bool> has_records(moderns.size(), true);
+    if (!pipelined) {
+      merge_vcfs(&archaic, pointers(moderns), has_records, writer.get());
+    } else {
+      // parse each vcf, merge and write output on separate threads
+      Pipelined_VCF_File pipelined_archaic(&archaic, true);
+      std::vector<std::unique_ptr<Pipelined_VCF_File>> pipelined_moderns;
+      for (auto &modern : moderns)
+        pipelined_moderns.emplace_back(new Pipelined_VCF_File(modern.get()));
+      Pipelined_Genotype_Writer pipelined_writer(writer.get());
+      merge_vcfs(&pipelined_archaic, pointers(pipelined_moderns),
+                 has_records, &pipelined_writer);
+      pipelined_writer.finish();
+    }
+    writer->flush();
+
+    if (of.is_open()) of.close();
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
+    return 1;
+  }
 
   return 0;
 }
@@ -0,0 +1,55 @@
+#include "IBDmix/genotype_pipeline.h"
+
+#include <utility>
+
+Pipelined_Genotype_Reader::Pipelined_Genotype_Reader(Genotype_Reader *reader,
+                                                     int block_sites)
+    : reader(reader),
+      full(GENOTYPE_PIPELINE_BLOCKS),
+      empty(GENOTYPE_PIPELINE_BLOCKS) {
+  for (int i = 0; i < GENOTYPE_PIPELINE_BLOCKS; ++i) {
+    std::unique_ptr<Batch> batch(new Batch);
+    reader->initialize_block(&batch->block, block_sites);
+    empty.try_push(std::move(batch));
+  }
+  thread = std::thread(&Pipelined_Genotype_Reader::read, this);
+}
+
+Pipelined_Genotype_Reader::~Pipelined_Genotype_Reader() {
+  stopping = true;
+  full.wake();
+  empty.wake();
+  thread.join();
+}
+
+void Pipelined_Genotype_Reader::read() {
+  std::unique_ptr<Batch> batch;
+  bool last = false;
+  while (!last) {
+    if (!empty.pop(&batch, stopping)) return;
+    try {
+      last = reader->update(&batch->block) == 0;
+    } catch (...) {
+      batch->block.sites = 0;
+      batch->error = std::current_exception();
+      last = true;
+    }
+    batch->last = last;
+    if (!full.push(std::move(batch), stopping)) return;
+  }
+}
+
+const Genotype_Block *Pipelined_Genotype_Reader::update() {
+  if (batch) {
+    // stay on the end of the file
+    if (batch->last) return nullptr;
+    empty.try_push(std::move(batch));
+  }
+  full.pop(&batch);
+  if (batch->error) {
+    batch->last = true;
+    std::rethrow_exception(batch->error);
+  }
+  if (batch->last) return nullptr;
+  return &batch->block;
+}
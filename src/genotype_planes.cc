@@ -0,0 +1,52 @@
+#include "IBDmix/genotype_planes.h"
+
+void Genotype_Planes::resize(int samples) {
+  this->samples = samples;
+  int words = (samples + 64) / 64;
+  first.assign(words, 0);
+  second.assign(words, 0);
+  missing.assign(words, 0);
+}
+
+void Genotype_Planes::set(const char *genotypes, const int *indices) {
+  slice_genotypes(genotypes, indices, samples, first.data(), second.data(),
+                  missing.data());
+  // clear the extra word when samples is a multiple of 64
+  if (samples % 64 == 0) first.back() = second.back() = missing.back() = 0;
+}
+
+void Genotype_Planes::set_all_except(const char *genotypes, int skip) {
+  slice_genotypes_contiguous(genotypes, samples + 1, first.data(),
+                             second.data(), missing.data());
+  remove_bit(&first, skip);
+  remove_bit(&second, skip);
+  remove_bit(&missing, skip);
+}
+
+void Genotype_Planes::remove_bit(std::vector<uint64_t> *plane, int bit) {
+  // shift the bits above down by one, carrying across words
+  std::vector<uint64_t> &words = *plane;
+  size_t word = bit / 64;
+  uint64_t below = (uint64_t(1) << (bit % 64)) - 1;
+  words[word] = (words[word] & below) | ((words[word] >> 1) & ~below);
+  for (size_t i = word + 1; i < words.size(); ++i) {
+    words[i - 1] |= words[i] << 63;
+    words[i] >>= 1;
+  }
+}
+
+Allele_Counts Genotype_Planes::count() const {
+  Allele_Counts counts = {samples, 0};
+  for (size_t i = 0; i < missing.size(); ++i) {
+    counts.called -= __builtin_popcountll(missing[i]);
+    counts.alt += __builtin_popcountll(first[i]) +
+                  __builtin_popcountll(second[i]);
+  }
+  return counts;
+}
+
+void Genotype_Planes::fill_lods(const Genotype_Table &table, lod_t *lods,
+                                unsigned char *recover_type) const {
+  fill_lods_planes(first.data(), second.data(), missing.data(), samples,
+                   table, lods, recover_type);
+}
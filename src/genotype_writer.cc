@@ -0,0 +1,67 @@
+#include "IBDmix/genotype_writer.h"
+
+#include <algorithm>
+
+#include "IBDmix/genotype_format.h"
+
+void Text_Genotype_Writer::writeHeader() {
+  buffer << "chrom\tpos\tref\talt";
+  for (auto &sample : samples) buffer << '\t' << sample;
+  buffer << '\n';
+}
+
+void Text_Genotype_Writer::writeSite(
+    const std::string &chromosome, uint64_t position, char reference,
+    char alternative, const std::vector<const std::string *> &genotypes) {
+  buffer << chromosome << '\t' << position << '\t' << reference << '\t'
+         << alternative << '\t';
+  for (auto genotype : genotypes) buffer << *genotype;
+  buffer << '\n';
+}
+
+Binary_Genotype_Writer::Binary_Genotype_Writer(
+    std::ostream &output, const std::vector<std::string> &samples)
+    : Genotype_Writer(output, samples), packed(packed_size(samples.size())) {}
+
+void Binary_Genotype_Writer::write_int(uint64_t value, int bytes) {
+  char result[8];
+  for (int i = 0; i < bytes; ++i) result[i] = (value >> (8 * i)) & 0xff;
+  buffer.write(result, bytes);
+}
+
+void Binary_Genotype_Writer::writeHeader() {
+  buffer.write(BINARY_MAGIC, BINARY_MAGIC_LENGTH);
+  write_int(samples.size(), 4);
+  for (auto &sample : samples) {
+    write_int(sample.size(), 4);
+    buffer << sample;
+  }
+}
+
+int Binary_Genotype_Writer::pack(const std::string &genotypes, int index) {
+  // add genotypes (every other character) to packed starting at sample index
+  for (unsigned int i = 0; i < genotypes.size(); i += 2, ++index)
+    packed[index / 4] |= pack_genotype(genotypes[i]) << (2 * (index % 4));
+  return index;
+}
+
+void Binary_Genotype_Writer::writeSite(
+    const std::string &chromosome, uint64_t position, char reference,
+    char alternative, const std::vector<const std::string *> &genotypes) {
+  if (chromosome != this->chromosome) {
+    this->chromosome = chromosome;
+    buffer.put(BINARY_CHROMOSOME);
+    write_int(chromosome.size(), 4);
+    buffer << chromosome;
+  }
+
+  std::fill(packed.begin(), packed.end(), 0);
+  int index = 0;
+  for (auto genotype : genotypes) index = pack(*genotype, index);
+
+  buffer.put(BINARY_SITE);
+  write_int(position, 8);
+  buffer.put(reference);
+  buffer.put(alternative);
+  buffer.write(packed.data(), packed.size());
+}
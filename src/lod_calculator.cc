@@ -2,6 +2,14 @@
 
 #include <math.h>
 
+#include <algorithm>
+
+namespace {
+// archaic genotypes (0, 1, 2) x selected x modern genotypes (0, 1, 2)
+constexpr int TABLE_ENTRY = 3 * 2 * 3;
+constexpr size_t TABLE_MAX_BYTES = 64 << 20;
+}  // namespace
+
 double LodCalculator::get_modern_error(double frequency) const {
   if (frequency > 0.5)  // convert to minor frequency
     frequency = 1 - frequency;
@@ -52,7 +60,45 @@ void LodCalculator::update_lod_cache(char archaic, double freq_b,
   }
 }
 
-double LodCalculator::calculate_lod(char modern) const {
-  if (modern == '9') return 0;
-  return lod_cache[modern - '0'];
+void LodCalculator::initialize_table(int samples) {
+  table.clear();
+  table.resize(samples + 1);
+  table_bytes = 0;
+}
+
+void LodCalculator::update_lod_cache(char archaic, int alt_count,
+                                     int called_count, bool selected) {
+  // matches the frequency of Genotype_Reader::find_frequency
+  double freq_b = called_count == 0
+                      ? 0
+                      : static_cast<double>(alt_count) / (2 * called_count);
+  int code = archaic - '0';
+  if (code < 0 || code > 2 || called_count >= static_cast<int>(table.size()) ||
+      alt_count < 0 || alt_count > 2 * called_count) {
+    update_lod_cache(archaic, freq_b, selected);
+    return;
+  }
+
+  Table_Row &row = table[called_count];
+  if (row.lods.empty()) {
+    size_t entries = 2 * called_count + 1;
+    size_t bytes = entries * (TABLE_ENTRY * sizeof(double) + 6);
+    if (table_bytes + bytes > TABLE_MAX_BYTES) {
+      update_lod_cache(archaic, freq_b, selected);
+      return;
+    }
+    table_bytes += bytes;
+    row.lods.resize(entries * TABLE_ENTRY);
+    row.computed.resize(entries * 6);
+  }
+
+  int slot = alt_count * 6 + code * 2 + selected;
+  double *entry = &row.lods[slot * 3];
+  if (row.computed[slot]) {
+    std::copy(entry, entry + 3, lod_cache.begin());
+  } else {
+    update_lod_cache(archaic, freq_b, selected);
+    std::copy(lod_cache.begin(), lod_cache.end(), entry);
+    row.computed[slot] = true;
+  }
 }
@@ -0,0 +1,56 @@
+#!/bin/bash
+
+if [[ $# -lt 2 ]]; then
+    echo "USAGE: $0 BUILD_DIR IBDMIX_OPTIONS..."
+    echo "Runs ibdmix and ibdmix_float from BUILD_DIR with the options,"
+    echo "excluding -o, and reports differences in the regions."
+    echo "Exits with 1 if any region boundaries differ."
+    exit 1
+fi
+
+build=$1
+shift
+
+double_out=$(mktemp)
+float_out=$(mktemp)
+trap 'rm -f $double_out $float_out' EXIT
+
+"$build/ibdmix" "$@" -o $double_out || exit 1
+"$build/ibdmix_float" "$@" -o $float_out || exit 1
+
+# regions are keyed by ID, chrom, start and end
+awk -F'\t' -v OFS='\t' '
+FNR == 1{ next }
+NR == FNR{
+    double_lod[$1 OFS $2 OFS $3 OFS $4] = $5
+    double_regions++
+    next
+}
+{
+    key = $1 OFS $2 OFS $3 OFS $4
+    float_regions++
+    if(!(key in double_lod)){
+        print "float only", key, $5
+        boundaries++
+        next
+    }
+    if(double_lod[key] != $5){
+        diff = $5 - double_lod[key]
+        if(diff < 0) diff = -diff
+        if(diff > max_diff) max_diff = diff
+        lods++
+        print "slod", key, double_lod[key], $5
+    }
+    delete double_lod[key]
+}
+END{
+    for(key in double_lod){
+        print "double only", key, double_lod[key]
+        boundaries++
+    }
+    print "regions: " double_regions + 0 " double, " float_regions + 0 " float"
+    print "boundary differences: " boundaries + 0
+    print "slod differences: " lods + 0 ", max " max_diff + 0
+    exit (boundaries > 0)
+}
+' $double_out $float_out
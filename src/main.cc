@@ -7,12 +7,14 @@
 
 #include "IBDmix/Genotype_Reader.h"
 #include "IBDmix/IBD_Collection.h"
+#include "IBDmix/genotype_pipeline.h"
 
 int main(int argc, char *argv[]) {
   CLI::App app{"Find probable IBD regions"};
 
   std::string genotype_file;
-  app.add_option("-g,--genotype", genotype_file, "The genotype file")
+  app.add_option("-g,--genotype", genotype_file,
+                 "The genotype file, text or binary from generate_gt")
       ->check(CLI::ExistingFile)
       ->required();
 
@@ -36,6 +38,13 @@ int main(int argc, char *argv[]) {
                  "Regions in bed file have LOD set to 0")
       ->check(CLI::ExistingFile);
 
+  std::string frequency_file = "";
+  app.add_option("-f,--frequency", frequency_file,
+                 "File of precomputed alt allele frequencies, with columns "
+                 "chrom, pos, frequency and optionally allele number.  "
+                 "Replaces the frequency of the selected samples")
+      ->check(CLI::ExistingFile);
+
   int ma_threshold = 1;
   double LOD_threshold = 3.0;
   double archaic_error = 0.01;
@@ -66,15 +75,23 @@ int main(int argc, char *argv[]) {
                "Also include LOD scores of positive LOD as a CSV list. "
                "Same order as SNPs.");
 
+  int threads = 1;
+  app.add_option("--threads", threads,
+                 "Number of threads.  With more than one, the genotype file "
+                 "is read on one thread and the rest find regions, each "
+                 "processing a share of the samples");
+
   CLI11_PARSE(app, argc, argv);
 
   std::ifstream genotype;
-  genotype.open(genotype_file);
+  genotype.open(genotype_file, std::ios::binary);
 
   std::ifstream sample;
   if (sample_file != "") sample.open(sample_file);
   std::ifstream mask;
   if (mask_file != "") mask.open(mask_file);
+  std::ifstream frequency;
+  if (frequency_file != "") frequency.open(frequency_file);
 
   // if output of end should be start, end) [exclusive end point]
   // or start, end] [inclusive end point; set exclusive to false]
@@ -96,12 +113,16 @@ int main(int argc, char *argv[]) {
   Genotype_Reader reader(&genotype, &mask, archaic_error, modern_error_max,
                          modern_error_prop,
                          1e-200,  // minesp
-                         ma_threshold);
+                         ma_threshold,
+                         frequency_file != "" ? &frequency : nullptr);
 
   int num_samples = reader.initialize(sample, archaic);
   if (sample.is_open()) sample.close();
 
-  IBD_Collection ibds(LOD_threshold, exclusive_end);
+  // with more than one thread, LODs are calculated on a reading thread
+  bool pipelined = threads > 1;
+  IBD_Collection ibds(LOD_threshold, exclusive_end,
+                      pipelined ? threads - 1 : 1);
 
   ibds.initialize(reader);
   if (more_stats) ibds.add_recorder(IBD_Collection::Recorder::counts);
@@ -111,11 +132,19 @@ int main(int argc, char *argv[]) {
   ibds.writeHeader(output);
   output << '\n';
 
-  while (reader.update()) ibds.update(reader, output);
+  if (pipelined) {
+    // read and calculate LODs on a separate thread
+    Pipelined_Genotype_Reader pipelined_reader(&reader);
+    while (const Genotype_Block *block = pipelined_reader.update())
+      ibds.update(*block, output);
+  } else {
+    while (reader.update()) ibds.update(reader, output);
+  }
 
   ibds.purge(output);
 
   genotype.close();
   if (mask.is_open()) mask.close();
+  if (frequency.is_open()) frequency.close();
   if (of.is_open()) of.close();
 }
@@ -0,0 +1,67 @@
+#include "IBDmix/output_buffer.h"
+
+#include <cstdio>
+
+namespace {
+// two digit pairs "00" to "99" for integer formatting
+struct Digit_Pairs {
+  char digits[200];
+  Digit_Pairs() {
+    for (int i = 0; i < 100; ++i) {
+      digits[2 * i] = '0' + i / 10;
+      digits[2 * i + 1] = '0' + i % 10;
+    }
+  }
+};
+
+const Digit_Pairs digit_pairs;
+
+// longest uint64_t is 20 digits
+constexpr int MAX_DIGITS = 20;
+// longest %g output with precision 6, e.g. -1.23457e-100
+constexpr int MAX_DOUBLE = 32;
+}  // namespace
+
+Output_Buffer::Output_Buffer(std::ostream &output, size_t capacity)
+    : output(output), buffer(capacity < MAX_DOUBLE ? MAX_DOUBLE : capacity) {}
+
+void Output_Buffer::flush() {
+  if (size > 0) output.write(buffer.data(), size);
+  size = 0;
+}
+
+void Output_Buffer::write_uint(uint64_t value) {
+  // fill from the end of a scratch buffer, two digits at a time
+  char digits[MAX_DIGITS];
+  char *start = digits + MAX_DIGITS;
+  while (value >= 100) {
+    const char *pair = &digit_pairs.digits[2 * (value % 100)];
+    value /= 100;
+    *--start = pair[1];
+    *--start = pair[0];
+  }
+  if (value >= 10) {
+    const char *pair = &digit_pairs.digits[2 * value];
+    *--start = pair[1];
+    *--start = pair[0];
+  } else {
+    *--start = '0' + value;
+  }
+  write(start, digits + MAX_DIGITS - start);
+}
+
+void Output_Buffer::write_int(int64_t value) {
+  if (value < 0) {
+    put('-');
+    // negate as unsigned to handle the minimum value
+    write_uint(~static_cast<uint64_t>(value) + 1);
+  } else {
+    write_uint(value);
+  }
+}
+
+void Output_Buffer::write_double(double value) {
+  // default ostream formatting is %g with precision 6
+  if (size + MAX_DOUBLE > buffer.size()) flush();
+  size += snprintf(&buffer[size], MAX_DOUBLE, "%g", value);
+}
@@ -0,0 +1,511 @@
+#include "IBDmix/simd_kernels.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define IBDMIX_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+using decode_function = bool (*)(const char *, char *, int);
+using contiguous_function = void (*)(const char *, int, uint64_t *,
+                                     uint64_t *, uint64_t *);
+using planes_function = void (*)(const uint64_t *, const uint64_t *,
+                                 const uint64_t *, int,
+                                 const Genotype_Table &, lod_t *,
+                                 unsigned char *);
+using slice_function = void (*)(const char *, const int *, int, uint64_t *,
+                                uint64_t *, uint64_t *);
+using nonnegative_function = void (*)(const lod_t *, int, uint64_t *);
+using find_function = int (*)(const lod_t *, int);
+
+decode_function select_decode() {
+  if (cpu_has_avx2()) return decode_gt_avx2;
+  if (cpu_has_sse42()) return decode_gt_sse42;
+  return decode_gt_scalar;
+}
+
+const decode_function best_decode = select_decode();
+const contiguous_function best_contiguous =
+    cpu_has_avx2() ? slice_genotypes_contiguous_avx2
+                   : slice_genotypes_contiguous_scalar;
+const planes_function best_planes =
+    cpu_has_avx2() ? fill_lods_planes_avx2 : fill_lods_planes_scalar;
+const slice_function best_slice =
+    cpu_has_avx2() ? slice_genotypes_avx2 : slice_genotypes_scalar;
+const nonnegative_function best_nonnegative =
+    cpu_has_avx2() ? nonnegative_lods_avx2 : nonnegative_lods_scalar;
+const find_function best_find =
+    cpu_has_avx2() ? find_nonnegative_lod_avx2 : find_nonnegative_lod_scalar;
+
+// bitplanes where sample i is at genotypes[2 * index(i)]
+template <typename Index>
+void slice_samples(const char *genotypes, Index index, int count,
+                   uint64_t *first, uint64_t *second, uint64_t *missing) {
+  for (int word = 0; word * 64 < count; ++word) {
+    uint64_t first_bits = 0, second_bits = 0, missing_bits = 0;
+    int samples = count - word * 64 < 64 ? count - word * 64 : 64;
+    for (int i = 0; i < samples; ++i) {
+      char genotype = genotypes[2 * index(word * 64 + i)];
+      uint64_t bit = uint64_t(1) << i;
+      if (genotype == '1' || genotype == '2') first_bits |= bit;
+      if (genotype == '2') second_bits |= bit;
+      if (genotype < '0' || genotype > '2') missing_bits |= bit;
+    }
+    first[word] = first_bits;
+    second[word] = second_bits;
+    missing[word] = missing_bits;
+  }
+}
+}  // namespace
+
+bool cpu_has_sse42() {
+#ifdef IBDMIX_X86
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse4.2");
+#else
+  return false;
+#endif
+}
+
+bool cpu_has_avx2() {
+#ifdef IBDMIX_X86
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#else
+  return false;
+#endif
+}
+
+bool decode_gt(const char *start, char *genotypes, int count) {
+  return best_decode(start, genotypes, count);
+}
+
+void slice_genotypes_contiguous(const char *genotypes, int count,
+                                uint64_t *first, uint64_t *second,
+                                uint64_t *missing) {
+  best_contiguous(genotypes, count, first, second, missing);
+}
+
+void fill_lods_planes(const uint64_t *first, const uint64_t *second,
+                      const uint64_t *missing, int count,
+                      const Genotype_Table &table, lod_t *lods,
+                      unsigned char *recover_type) {
+  best_planes(first, second, missing, count, table, lods, recover_type);
+}
+
+void slice_genotypes(const char *genotypes, const int *indices, int count,
+                     uint64_t *first, uint64_t *second, uint64_t *missing) {
+  best_slice(genotypes, indices, count, first, second, missing);
+}
+
+void nonnegative_lods(const lod_t *lods, int count, uint64_t *bits) {
+  best_nonnegative(lods, count, bits);
+}
+
+int find_nonnegative_lod(const lod_t *lods, int count) {
+  return best_find(lods, count);
+}
+
+void fill_lods_planes_scalar(const uint64_t *first, const uint64_t *second,
+                             const uint64_t *missing, int count,
+                             const Genotype_Table &table, lod_t *lods,
+                             unsigned char *recover_type) {
+  for (int word = 0; word * 64 < count; ++word) {
+    uint64_t first_bits = first[word], second_bits = second[word],
+             missing_bits = missing[word];
+    int samples = count - word * 64 < 64 ? count - word * 64 : 64;
+    for (int i = 0; i < samples; ++i) {
+      // missing samples have no alt bits, or-ing 3 selects the last entry
+      int code = static_cast<int>((first_bits & 1) + (second_bits & 1)) |
+                 static_cast<int>(missing_bits & 1) * 3;
+      lods[i] = table.lods[code];
+      recover_type[i] = table.recover[code];
+      first_bits >>= 1;
+      second_bits >>= 1;
+      missing_bits >>= 1;
+    }
+    lods += 64;
+    recover_type += 64;
+  }
+}
+
+void slice_genotypes_scalar(const char *genotypes, const int *indices,
+                            int count, uint64_t *first, uint64_t *second,
+                            uint64_t *missing) {
+  slice_samples(genotypes, [indices](int i) { return indices[i]; }, count,
+                first, second, missing);
+}
+
+void slice_genotypes_contiguous_scalar(const char *genotypes, int count,
+                                       uint64_t *first, uint64_t *second,
+                                       uint64_t *missing) {
+  slice_samples(genotypes, [](int i) { return i; }, count, first, second,
+                missing);
+}
+
+// not below 0 rather than at least 0, as the comparison of the avx2
+// versions, so NaN is included
+void nonnegative_lods_scalar(const lod_t *lods, int count, uint64_t *bits) {
+  for (int word = 0; word * 64 < count; ++word) {
+    uint64_t word_bits = 0;
+    int samples = count - word * 64 < 64 ? count - word * 64 : 64;
+    for (int i = 0; i < samples; ++i)
+      word_bits |= static_cast<uint64_t>(!(lods[i] < 0)) << i;
+    bits[word] = word_bits;
+    lods += 64;
+  }
+}
+
+int find_nonnegative_lod_scalar(const lod_t *lods, int count) {
+  for (int i = 0; i < count; ++i)
+    if (!(lods[i] < 0)) return i;
+  return count;
+}
+
+bool decode_gt_scalar(const char *start, char *genotypes, int count) {
+  bool none_valid = true;
+  for (int i = 0; i < count; ++i) {
+    char genotype = start[0] + start[2] - '0';
+    // ',' = '.' + '.' - '0'
+    genotype = genotype == ',' ? '9' : genotype;
+    if (genotype != '9') none_valid = false;
+    genotypes[2 * i] = genotype;
+    genotypes[2 * i + 1] = '\t';
+    start += 4;  // gt (2) separator and tab
+  }
+  return none_valid;
+}
+
+#ifdef IBDMIX_X86
+// Each 32 bit lane holds one sample, "a|b\t".  The genotype is computed
+// in the low byte of the lane as a + b - '0', matching the scalar char
+// arithmetic, then ',' is replaced with '9'.
+__attribute__((target("sse4.2"))) static inline __m128i decode4(
+    __m128i samples, __m128i *all_missing) {
+  const __m128i low_byte = _mm_set1_epi32(0xff);
+  __m128i genotype = _mm_add_epi32(
+      _mm_and_si128(samples, low_byte),
+      _mm_and_si128(_mm_srli_epi32(samples, 16), low_byte));
+  genotype = _mm_and_si128(_mm_sub_epi32(genotype, _mm_set1_epi32('0')),
+                           low_byte);
+  genotype = _mm_blendv_epi8(
+      genotype, _mm_set1_epi32('9'),
+      _mm_cmpeq_epi32(genotype, _mm_set1_epi32(',')));
+  *all_missing = _mm_and_si128(
+      *all_missing, _mm_cmpeq_epi32(genotype, _mm_set1_epi32('9')));
+  // tab in the second byte for the output
+  return _mm_or_si128(genotype, _mm_set1_epi32('\t' << 8));
+}
+
+__attribute__((target("sse4.2"))) bool decode_gt_sse42(const char *start,
+                                                       char *genotypes,
+                                                       int count) {
+  __m128i all_missing = _mm_set1_epi32(-1);
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m128i *input = reinterpret_cast<const __m128i *>(start + 4 * i);
+    __m128i first = decode4(_mm_loadu_si128(input), &all_missing);
+    __m128i second = decode4(_mm_loadu_si128(input + 1), &all_missing);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(genotypes + 2 * i),
+                     _mm_packus_epi32(first, second));
+  }
+  bool none_valid = _mm_movemask_epi8(all_missing) == 0xffff;
+  if (i < count)
+    none_valid &= decode_gt_scalar(start + 4 * i, genotypes + 2 * i,
+                                   count - i);
+  return none_valid;
+}
+
+__attribute__((target("avx2"))) static inline __m256i decode8(
+    __m256i samples, __m256i *all_missing) {
+  const __m256i low_byte = _mm256_set1_epi32(0xff);
+  __m256i genotype = _mm256_add_epi32(
+      _mm256_and_si256(samples, low_byte),
+      _mm256_and_si256(_mm256_srli_epi32(samples, 16), low_byte));
+  genotype = _mm256_and_si256(
+      _mm256_sub_epi32(genotype, _mm256_set1_epi32('0')), low_byte);
+  genotype = _mm256_blendv_epi8(
+      genotype, _mm256_set1_epi32('9'),
+      _mm256_cmpeq_epi32(genotype, _mm256_set1_epi32(',')));
+  *all_missing = _mm256_and_si256(
+      *all_missing, _mm256_cmpeq_epi32(genotype, _mm256_set1_epi32('9')));
+  return _mm256_or_si256(genotype, _mm256_set1_epi32('\t' << 8));
+}
+
+__attribute__((target("avx2"))) bool decode_gt_avx2(const char *start,
+                                                    char *genotypes,
+                                                    int count) {
+  __m256i all_missing = _mm256_set1_epi32(-1);
+  int i = 0;
+  for (; i + 16 <= count; i += 16) {
+    const __m256i *input = reinterpret_cast<const __m256i *>(start + 4 * i);
+    __m256i first = decode8(_mm256_loadu_si256(input), &all_missing);
+    __m256i second = decode8(_mm256_loadu_si256(input + 1), &all_missing);
+    // packing works within 128 bit lanes, reorder to restore sample order
+    __m256i packed = _mm256_permute4x64_epi64(
+        _mm256_packus_epi32(first, second), 0xd8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(genotypes + 2 * i),
+                        packed);
+  }
+  bool none_valid = _mm256_movemask_epi8(all_missing) == -1;
+  // avoid the avx to sse transition penalty in the non-vex sse42 kernel
+  _mm256_zeroupper();
+  if (i < count)
+    none_valid &= decode_gt_sse42(start + 4 * i, genotypes + 2 * i,
+                                  count - i);
+  return none_valid;
+}
+
+// Table entries of 8 genotype codes, one per 32 bit lane.  LODs are
+// selected by permuting the table as 8 floats, 2 per double LOD, and
+// recover types by a byte shuffle of the codes
+__attribute__((target("avx2"))) static inline void store_entries(
+    __m256i codes, __m256 lod_table, __m256i recover_table, lod_t *lods,
+    unsigned char *recover_type) {
+  // low byte of each lane to the first 4 bytes of each 128 bit half
+  const __m256i compact = _mm256_setr_epi8(
+      0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 4, 8,
+      12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+#ifdef IBDMIX_FLOAT_LODS
+  // single precision LODs are selected directly, 8 per store
+  _mm256_storeu_ps(lods, _mm256_permutevar8x32_ps(lod_table, codes));
+#else
+  const __m256i odd = _mm256_set1_epi64x(int64_t(1) << 32);
+  // float indices 2 * code and 2 * code + 1 for each double
+  __m256i doubled = _mm256_slli_epi32(codes, 1);
+  __m256i first = _mm256_cvtepu32_epi64(_mm256_castsi256_si128(doubled));
+  __m256i second = _mm256_cvtepu32_epi64(_mm256_extracti128_si256(doubled, 1));
+  first = _mm256_or_si256(first,
+                          _mm256_or_si256(_mm256_slli_epi64(first, 32), odd));
+  second = _mm256_or_si256(
+      second, _mm256_or_si256(_mm256_slli_epi64(second, 32), odd));
+  _mm256_storeu_pd(lods, _mm256_castps_pd(
+                             _mm256_permutevar8x32_ps(lod_table, first)));
+  _mm256_storeu_pd(lods + 4, _mm256_castps_pd(
+                                 _mm256_permutevar8x32_ps(lod_table, second)));
+#endif
+
+  __m256i recover = _mm256_shuffle_epi8(recover_table,
+                                        _mm256_shuffle_epi8(codes, compact));
+  int32_t halves[2] = {
+      _mm_cvtsi128_si32(_mm256_castsi256_si128(recover)),
+      _mm_cvtsi128_si32(_mm256_extracti128_si256(recover, 1))};
+  memcpy(recover_type, halves, 8);
+}
+
+// the 4 LODs of table in the low 128 bits for float, all 256 for double
+__attribute__((target("avx2"))) static inline __m256 lod_entries(
+    const Genotype_Table &table) {
+#ifdef IBDMIX_FLOAT_LODS
+  return _mm256_castps128_ps256(_mm_loadu_ps(table.lods));
+#else
+  return _mm256_castpd_ps(_mm256_loadu_pd(table.lods));
+#endif
+}
+
+__attribute__((target("avx2"))) static inline __m256i recover_entries(
+    const Genotype_Table &table) {
+  int32_t entries;
+  memcpy(&entries, table.recover, 4);
+  return _mm256_set1_epi32(entries);
+}
+
+// 32 samples per 2 loads.  The genotype bytes are packed out from between
+// the tabs, then each comparison mask gives 32 bits of a plane
+__attribute__((target("avx2"))) void slice_genotypes_contiguous_avx2(
+    const char *genotypes, int count, uint64_t *first, uint64_t *second,
+    uint64_t *missing) {
+  const __m256i low_byte = _mm256_set1_epi16(0xff);
+  const __m256i zeros = _mm256_set1_epi8('0');
+  const __m256i ones = _mm256_set1_epi8('1');
+  const __m256i twos = _mm256_set1_epi8('2');
+  int full_words = count / 64;
+  for (int word = 0; word < full_words; ++word) {
+    uint64_t first_bits = 0, second_bits = 0, called_bits = 0;
+    for (int half = 0; half < 2; ++half) {
+      const __m256i *input = reinterpret_cast<const __m256i *>(
+          genotypes + 2 * (word * 64 + half * 32));
+      __m256i low = _mm256_and_si256(_mm256_loadu_si256(input), low_byte);
+      __m256i high =
+          _mm256_and_si256(_mm256_loadu_si256(input + 1), low_byte);
+      // packing works within 128 bit lanes, reorder to restore sample order
+      __m256i values =
+          _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xd8);
+      uint64_t is_zero = static_cast<uint32_t>(
+          _mm256_movemask_epi8(_mm256_cmpeq_epi8(values, zeros)));
+      uint64_t is_one = static_cast<uint32_t>(
+          _mm256_movemask_epi8(_mm256_cmpeq_epi8(values, ones)));
+      uint64_t is_two = static_cast<uint32_t>(
+          _mm256_movemask_epi8(_mm256_cmpeq_epi8(values, twos)));
+      first_bits |= (is_one | is_two) << (32 * half);
+      second_bits |= is_two << (32 * half);
+      called_bits |= (is_zero | is_one | is_two) << (32 * half);
+    }
+    first[word] = first_bits;
+    second[word] = second_bits;
+    missing[word] = ~called_bits;
+  }
+  if (full_words * 64 < count)
+    slice_genotypes_contiguous_scalar(
+        genotypes + 2 * full_words * 64, count - full_words * 64,
+        first + full_words, second + full_words, missing + full_words);
+}
+
+// 8 samples per step, the plane bits of each sample are tested in its lane
+__attribute__((target("avx2"))) void fill_lods_planes_avx2(
+    const uint64_t *first, const uint64_t *second, const uint64_t *missing,
+    int count, const Genotype_Table &table, lod_t *lods,
+    unsigned char *recover_type) {
+  const __m256i lane_bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+  const __m256i threes = _mm256_set1_epi32(3);
+  const __m256 lod_table = lod_entries(table);
+  const __m256i recover_table = recover_entries(table);
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    int word = i / 64, shift = i % 64;
+    __m256i first_set = _mm256_cmpeq_epi32(
+        _mm256_and_si256(_mm256_set1_epi32(first[word] >> shift), lane_bits),
+        lane_bits);
+    __m256i second_set = _mm256_cmpeq_epi32(
+        _mm256_and_si256(_mm256_set1_epi32(second[word] >> shift), lane_bits),
+        lane_bits);
+    __m256i missing_set = _mm256_cmpeq_epi32(
+        _mm256_and_si256(_mm256_set1_epi32(missing[word] >> shift),
+                         lane_bits),
+        lane_bits);
+    // set masks are -1, so subtracting adds one per alt allele
+    __m256i codes = _mm256_or_si256(
+        _mm256_sub_epi32(_mm256_setzero_si256(),
+                         _mm256_add_epi32(first_set, second_set)),
+        _mm256_and_si256(missing_set, threes));
+    store_entries(codes, lod_table, recover_table, lods + i, recover_type + i);
+  }
+  for (; i < count; ++i) {
+    int word = i / 64, shift = i % 64;
+    int code = static_cast<int>(((first[word] >> shift) & 1) +
+                                ((second[word] >> shift) & 1)) |
+               static_cast<int>((missing[word] >> shift) & 1) * 3;
+    lods[i] = table.lods[code];
+    recover_type[i] = table.recover[code];
+  }
+}
+
+constexpr int LODS_PER_VECTOR = 32 / sizeof(lod_t);
+
+// a bit for each of LODS_PER_VECTOR lods not below 0
+__attribute__((target("avx2"))) static inline uint64_t nonnegative_mask(
+    const lod_t *lods) {
+#ifdef IBDMIX_FLOAT_LODS
+  return _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(lods),
+                                          _mm256_setzero_ps(), _CMP_NLT_UQ));
+#else
+  return _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(lods),
+                                          _mm256_setzero_pd(), _CMP_NLT_UQ));
+#endif
+}
+
+__attribute__((target("avx2"))) void nonnegative_lods_avx2(const lod_t *lods,
+                                                           int count,
+                                                           uint64_t *bits) {
+  int full_words = count / 64;
+  for (int word = 0; word < full_words; ++word) {
+    uint64_t word_bits = 0;
+    for (int i = 0; i < 64; i += LODS_PER_VECTOR)
+      word_bits |= nonnegative_mask(lods + word * 64 + i) << i;
+    bits[word] = word_bits;
+  }
+  if (full_words * 64 < count)
+    nonnegative_lods_scalar(lods + full_words * 64, count - full_words * 64,
+                            bits + full_words);
+}
+
+__attribute__((target("avx2"))) int find_nonnegative_lod_avx2(
+    const lod_t *lods, int count) {
+  int i = 0;
+  for (; i + LODS_PER_VECTOR <= count; i += LODS_PER_VECTOR) {
+    uint64_t mask = nonnegative_mask(lods + i);
+    if (mask != 0) return i + __builtin_ctzll(mask);
+  }
+  return i + find_nonnegative_lod_scalar(lods + i, count - i);
+}
+
+// 8 samples per gather.  Each lane loads the 4 bytes starting 2 before the
+// sample so the gather never reads past the tab following the sample, and
+// each comparison mask gives 8 bits of a plane
+__attribute__((target("avx2"))) void slice_genotypes_avx2(
+    const char *genotypes, const int *indices, int count, uint64_t *first,
+    uint64_t *second, uint64_t *missing) {
+  const __m256i low_byte = _mm256_set1_epi32(0xff);
+  const __m256i zeros = _mm256_set1_epi32('0');
+  const __m256i ones = _mm256_set1_epi32('1');
+  const __m256i twos = _mm256_set1_epi32('2');
+  const int *base = reinterpret_cast<const int *>(genotypes - 2);
+  int full_words = count / 64;
+  for (int word = 0; word < full_words; ++word) {
+    uint64_t first_bits = 0, second_bits = 0, called_bits = 0;
+    for (int i = 0; i < 64; i += 8) {
+      __m256i index = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(indices + word * 64 + i));
+      __m256i values = _mm256_and_si256(
+          _mm256_srli_epi32(_mm256_i32gather_epi32(base, index, 2), 16),
+          low_byte);
+      uint64_t is_zero = _mm256_movemask_ps(
+          _mm256_castsi256_ps(_mm256_cmpeq_epi32(values, zeros)));
+      uint64_t is_one = _mm256_movemask_ps(
+          _mm256_castsi256_ps(_mm256_cmpeq_epi32(values, ones)));
+      uint64_t is_two = _mm256_movemask_ps(
+          _mm256_castsi256_ps(_mm256_cmpeq_epi32(values, twos)));
+      first_bits |= (is_one | is_two) << i;
+      second_bits |= is_two << i;
+      called_bits |= (is_zero | is_one | is_two) << i;
+    }
+    first[word] = first_bits;
+    second[word] = second_bits;
+    missing[word] = ~called_bits;
+  }
+  if (full_words * 64 < count)
+    slice_genotypes_scalar(genotypes, indices + full_words * 64,
+                           count - full_words * 64, first + full_words,
+                           second + full_words, missing + full_words);
+}
+#else
+bool decode_gt_sse42(const char *start, char *genotypes, int count) {
+  return decode_gt_scalar(start, genotypes, count);
+}
+
+bool decode_gt_avx2(const char *start, char *genotypes, int count) {
+  return decode_gt_scalar(start, genotypes, count);
+}
+
+void slice_genotypes_avx2(const char *genotypes, const int *indices,
+                          int count, uint64_t *first, uint64_t *second,
+                          uint64_t *missing) {
+  slice_genotypes_scalar(genotypes, indices, count, first, second, missing);
+}
+
+void slice_genotypes_contiguous_avx2(const char *genotypes, int count,
+                                     uint64_t *first, uint64_t *second,
+                                     uint64_t *missing) {
+  slice_genotypes_contiguous_scalar(genotypes, count, first, second, missing);
+}
+
+void fill_lods_planes_avx2(const uint64_t *first, const uint64_t *second,
+                           const uint64_t *missing, int count,
+                           const Genotype_Table &table, lod_t *lods,
+                           unsigned char *recover_type) {
+  fill_lods_planes_scalar(first, second, missing, count, table, lods,
+                          recover_type);
+}
+
+void nonnegative_lods_avx2(const lod_t *lods, int count, uint64_t *bits) {
+  nonnegative_lods_scalar(lods, count, bits);
+}
+
+int find_nonnegative_lod_avx2(const lod_t *lods, int count) {
+  return find_nonnegative_lod_scalar(lods, count);
+}
+#endif
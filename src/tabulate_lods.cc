@@ -7,12 +7,14 @@
 #include <iostream>
 
 #include "IBDmix/Genotype_Reader.h"
+#include "IBDmix/output_buffer.h"
 
 int main(int argc, char *argv[]) {
   CLI::App app{"Calculate population specific LOD scores for all sites"};
 
   std::string genotype_file;
-  app.add_option("-g,--genotype", genotype_file, "The genotype file")
+  app.add_option("-g,--genotype", genotype_file,
+                 "The genotype file, text or binary from generate_gt")
       ->check(CLI::ExistingFile)
       ->required();
 
@@ -36,6 +38,13 @@ int main(int argc, char *argv[]) {
                  "Regions in bed file have LOD set to 0")
       ->check(CLI::ExistingFile);
 
+  std::string frequency_file = "";
+  app.add_option("-f,--frequency", frequency_file,
+                 "File of precomputed alt allele frequencies, with columns "
+                 "chrom, pos, frequency and optionally allele number.  "
+                 "Replaces the frequency of the selected samples")
+      ->check(CLI::ExistingFile);
+
   int ma_threshold = 1;
   double archaic_error = 0.01, modern_error_max = 0.0025, modern_error_prop = 2;
   bool include_ninfs = false;
@@ -59,12 +68,14 @@ int main(int argc, char *argv[]) {
   CLI11_PARSE(app, argc, argv);
 
   std::ifstream genotype;
-  genotype.open(genotype_file);
+  genotype.open(genotype_file, std::ios::binary);
 
   std::ifstream sample;
   if (sample_file != "") sample.open(sample_file);
   std::ifstream mask;
   if (mask_file != "") mask.open(mask_file);
+  std::ifstream frequency;
+  if (frequency_file != "") frequency.open(frequency_file);
 
   std::ofstream of;
   std::streambuf *buf;
@@ -74,7 +85,8 @@ int main(int argc, char *argv[]) {
     of.open(outfile);
     buf = of.rdbuf();
   }
-  std::ostream output(buf);
+  std::ostream stream(buf);
+  Output_Buffer output(stream);
 
   // write header
   output << "chrom\tpos\tref\talt\tarchaic\tfreq_b\t0\t1\t2\n";
@@ -82,7 +94,8 @@ int main(int argc, char *argv[]) {
   Genotype_Reader reader(&genotype, &mask, archaic_error, modern_error_max,
                          modern_error_prop,
                          1e-200,  // minesp
-                         ma_threshold);
+                         ma_threshold,
+                         frequency_file != "" ? &frequency : nullptr);
 
   int num_samples = reader.initialize(sample, archaic);
   if (sample.is_open()) sample.close();
@@ -117,7 +130,9 @@ int main(int argc, char *argv[]) {
            << lods[0] << '\t' << lods[1] << '\t' << lods[2] << '\n';
   }
 
+  output.flush();
   genotype.close();
   if (mask.is_open()) mask.close();
+  if (frequency.is_open()) frequency.close();
   if (of.is_open()) of.close();
 }
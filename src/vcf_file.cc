@@ -2,10 +2,52 @@
 
 #include <string.h>
 
+#include <set>
 #include <stdexcept>
 
-VCF_File::VCF_File(std::istream *in_file, std::ostream &output)
+#include "IBDmix/simd_kernels.h"
+
+namespace {
+// return the tab terminating the field at start, or line_end for the last
+inline const char *field_end(const char *start, const char *line_end) {
+  const void *tab = memchr(start, '\t', line_end - start);
+  return tab == nullptr ? line_end : static_cast<const char *>(tab);
+}
+
+// return the start of the field after the one terminated by end
+inline const char *next_field(const char *end, const char *line_end) {
+  return end == line_end ? end : end + 1;
+}
+
+// check the raw sample columns for a missing genotype ("./." or ".|.") in
+// every sample, without decoding.  GT must be the first FORMAT key
+bool raw_all_missing(const char *start, const char *line_end) {
+  for (; start < line_end;
+       start = next_field(field_end(start, line_end), line_end))
+    if (line_end - start < 3 || start[0] != '.' || start[2] != '.')
+      return false;
+  return true;
+}
+}  // namespace
+
+VCF_File::VCF_File(std::istream *in_file, std::ostream &output,
+                   const std::vector<std::string> &subset)
     : input(in_file) {
+  read_header(output, subset);
+}
+
+VCF_File::VCF_File(const std::string &filename, std::ostream &output,
+                   int threads, const std::vector<std::string> &subset)
+    : file_buffer(new BGZF_Streambuf(filename, threads)),
+      file_stream(new std::istream(file_buffer.get())),
+      input(file_stream.get()) {
+  // propagate decompression errors instead of ending the file silently
+  file_stream->exceptions(std::ios::badbit);
+  read_header(output, subset);
+}
+
+void VCF_File::read_header(std::ostream &output,
+                           const std::vector<std::string> &subset) {
   // setup lines for subsequent reading, write individuals to output
   number_individuals = 0;
   chromosome = "";
@@ -29,15 +71,25 @@ VCF_File::VCF_File(std::istream *in_file, std::ostream &output)
       iss >> token;  // INFO
       iss >> token;  // FORMAT
       // write indivs prepend with \t, count number
-      while (iss >> token) {
+      std::set<std::string> selected(subset.begin(), subset.end());
+      for (int column = 0; iss >> token; ++column) {
+        if (!subset.empty() && selected.count(token) == 0) continue;
+        // extend the last run for consecutive columns
+        if (!runs.empty() &&
+            runs.back().first + runs.back().second == column)
+          ++runs.back().second;
+        else
+          runs.emplace_back(column, 1);
         ++number_individuals;
         output << '\t' << token;
+        samples.push_back(token);
       }
       break;
     }
   }
 
-  if (number_individuals == 0) {
+  // a subset may not contain any samples of this file
+  if (number_individuals == 0 && subset.empty()) {
     std::cerr << "Ill-formed file, unable to parse header\n";
     exit(1);
   }
@@ -60,6 +112,15 @@ bool VCF_File::update(bool skip_non_informative) {
   return chromosome != "-";
 }
 
+void VCF_File::seek(const std::string &region, uint64_t virtual_offset) {
+  if (!file_buffer)
+    throw std::invalid_argument("Only vcf files opened by name can be seeked");
+  file_buffer->seek(virtual_offset);
+  input->clear();
+  this->region = region;
+  chromosome = "";
+}
+
 bool VCF_File::read_line(bool skip_non_informative) {
   // return true when the line is valid.  Only valid lines will yield from
   // update
@@ -68,99 +129,146 @@ bool VCF_File::read_line(bool skip_non_informative) {
     chromosome = "-";
     return false;
   }
-  iss.clear();
-  iss.str(buffer);
+  // scan the line once, splitting fields on tabs in place
+  const char *line_end = buffer.data() + buffer.size();
+  const char *start = buffer.data();
+  const char *end = field_end(start, line_end);  // CHROM
   // TODO report error on failure
-  if (!(iss >> chromosome && iss >> position)) return false;
+  if (end == start || end == line_end) return false;
+  chromosome.assign(start, end);
+  if (!region.empty() && chromosome != region) {
+    // past the end of the indexed region
+    chromosome = "-";
+    return false;
+  }
+
+  start = end + 1;
+  end = field_end(start, line_end);  // POS
+  if (!parse_position(start, end)) return false;
 
   // read in ref and alt alleles, skipping if > 1 character
-  std::string token;
-  iss >> token;  // ID
-  iss >> token;  // REF
-  if (token.size() != 1) {
+  end = field_end(next_field(end, line_end), line_end);  // ID
+  start = next_field(end, line_end);
+  end = field_end(start, line_end);  // REF
+  if (end - start != 1) {
     isvalid = false;
     return !skip_non_informative;  // this will allow checks if not skipping
   }
-  reference = token[0];
-  iss >> token;  // ALT
-  if (token.size() != 1) {
+  reference = *start;
+  start = next_field(end, line_end);
+  end = field_end(start, line_end);  // ALT
+  if (end - start != 1) {
     isvalid = false;
     return !skip_non_informative;  // this will allow checks if not skipping
   }
-  alternative = token[0];
+  alternative = *start;
 
-  // discard qual, filter, etc
-  iss >> token;  // QUAL
-  iss >> token;  // FILTER
-  iss >> token;  // INFO
-  iss >> token;  // FORMAT
+  // discard qual, filter and info
+  for (int i = 0; i < 3; ++i)
+    end = field_end(next_field(end, line_end), line_end);
+  start = next_field(end, line_end);
+  end = field_end(start, line_end);  // FORMAT
+  if (end == line_end) return false;  // no samples
 
-  // skip to sample
-  std::string::size_type ind = buffer.find('\t');
-  for (int i = 1; i < 9; ++i) ind = buffer.find('\t', ind + 1);
+  // reject missing records before decoding, common in archaic genomes
+  if (skip_non_informative && end - start >= 2 && start[0] == 'G' &&
+      start[1] == 'T' && (end - start == 2 || start[2] == ':') &&
+      raw_all_missing(end + 1, line_end))
+    return false;
 
-  bool none_valid = parse(buffer.c_str() + ind + 1, token);
+  bool none_valid = parse(end + 1, line_end, start, end - start);
 
   // return true if skip is false or
   // if skip is false but at least one informative found
   return !skip_non_informative || !none_valid;
 }
 
-bool VCF_File::parse(const char *start, std::string format) {
+bool VCF_File::informative(const std::string &genotypes) {
+  for (size_t i = 0; i < genotypes.size(); i += 2)
+    if (genotypes[i] != '0') return true;
+  return false;
+}
+
+bool VCF_File::parse_position(const char *start, const char *end) {
+  if (start == end) return false;
+  uint64_t result = 0;
+  for (; start != end; ++start) {
+    if (*start < '0' || *start > '9') return false;
+    result = result * 10 + (*start - '0');
+  }
+  position = result;
+  return true;
+}
+
+bool VCF_File::parse(const char *start, const char *line_end,
+                     const char *format, size_t length) {
   // check if format is GT, otherwise need to parse more carefully
-  if (format == "GT") {
+  if (length == 2 && format[0] == 'G' && format[1] == 'T') {
     return simpleParse(start);
   } else {
     // format is complex, split by : finding index of GT
     int ind = 0;
-    const char *fmt = format.c_str();
+    const char *format_end = format + length;
     for (;;) {
-      if (strncmp(fmt, "GT", 2) == 0) return complexParse(start, ind);
+      const char *fmt_end = static_cast<const char *>(
+          memchr(format, ':', format_end - format));
+      if (fmt_end == nullptr) fmt_end = format_end;
+      if (fmt_end - format == 2 && format[0] == 'G' && format[1] == 'T')
+        return complexParse(start, line_end, ind);
       ++ind;  // not found, onto next fmt
-      while (*fmt != ':' && *fmt != '\0') ++fmt;
-      if (*fmt == '\0') {
+      if (fmt_end == format_end) {
         throw std::invalid_argument("FORMAT must contain GT");
       }
-      ++fmt;
+      format = fmt_end + 1;
     }
   }
 }
 
 bool VCF_File::simpleParse(const char *start) {
+  // every sample is the fixed width "a|b\t", decode runs of selected
+  // samples with simd kernel, skipping the others
   bool none_valid = true;
-  unsigned int ind = 0;
-  while (ind < genotypes.size()) {
-    genotypes[ind] = start[0] + start[2] - '0';
-    // ',' = '.' + '.' - '0'
-    genotypes[ind] = genotypes[ind] == ',' ? '9' : genotypes[ind];
-    if (none_valid && genotypes[ind] != '9') none_valid = false;
-    ind += 2;
-    start += 4;  // gt (2) separator and tab
+  char *output = &genotypes[0];
+  for (auto &run : runs) {
+    // short runs are not worth the simd setup
+    if (run.second < 8)
+      none_valid &= decode_gt_scalar(start + 4 * run.first, output, run.second);
+    else
+      none_valid &= decode_gt(start + 4 * run.first, output, run.second);
+    output += 2 * run.second;
   }
   return none_valid;
 }
 
-bool VCF_File::complexParse(const char *start, int gtInd) {
+bool VCF_File::complexParse(const char *start, const char *line_end,
+                            int gtInd) {
   bool none_valid = true;
   unsigned int ind = 0;
-  while (ind < genotypes.size()) {
-    // move to the gtInd'th :
-    for (int i = 0; i < gtInd; ++i) {
-      for (; *start != ':'; ++start) {
+  int column = 0;
+  for (auto &run : runs) {
+    // skip unselected samples
+    for (; column < run.first && start < line_end; ++column)
+      start = next_field(field_end(start, line_end), line_end);
+
+    for (int sample = 0; sample < run.second; ++sample, ++column) {
+      // move to the gtInd'th :
+      for (int i = 0; i < gtInd; ++i) {
+        for (; *start != ':'; ++start) {
+        }
+        ++start;
       }
-      ++start;
-    }
 
-    genotypes[ind] = start[0] + start[2] - '0';
-    // ',' = '.' + '.' - '0'
-    genotypes[ind] = genotypes[ind] == ',' ? '9' : genotypes[ind];
-    if (none_valid && genotypes[ind] != '9') none_valid = false;
+      genotypes[ind] = start[0] + start[2] - '0';
+      // ',' = '.' + '.' - '0'
+      genotypes[ind] = genotypes[ind] == ',' ? '9' : genotypes[ind];
+      if (none_valid && genotypes[ind] != '9') none_valid = false;
 
-    ind += 2;
+      ind += 2;
 
-    // move to next tab or null
-    while (*start != '\t' && *start != '\0') ++start;
-    ++start;
+      // move to next tab or null
+      while (*start != '\t' && *start != '\0') ++start;
+      ++start;
+    }
   }
   return none_valid;
 }
@@ -0,0 +1,157 @@
+#include "IBDmix/vcf_index.h"
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include "IBDmix/bgzf_streambuf.h"
+
+namespace {
+// bin holding summary statistics instead of chunks of records
+constexpr uint32_t TABIX_PSEUDO_BIN = 37450;
+
+template <typename T>
+T read_value(std::istream *input) {
+  unsigned char bytes[sizeof(T)];
+  if (!input->read(reinterpret_cast<char *>(bytes), sizeof(T)))
+    throw std::invalid_argument("Truncated vcf index");
+  T result = 0;
+  for (int i = sizeof(T) - 1; i >= 0; --i) result = (result << 8) | bytes[i];
+  return result;
+}
+
+int32_t read_int(std::istream *input) {
+  return static_cast<int32_t>(read_value<uint32_t>(input));
+}
+
+bool file_exists(const std::string &filename) {
+  std::ifstream file(filename);
+  return file.good();
+}
+}  // namespace
+
+VCF_Index::VCF_Index(const std::string &index_file) {
+  // indices are bgzip compressed
+  BGZF_Streambuf buffer(index_file);
+  std::istream input(&buffer);
+  input.exceptions(std::ios::badbit);
+
+  char magic[4];
+  if (!input.read(magic, 4))
+    throw std::invalid_argument("Unable to read index " + index_file);
+  if (std::string(magic, 4) == std::string("TBI\1", 4))
+    read_tabix(&input);
+  else if (std::string(magic, 4) == std::string("CSI\1", 4))
+    read_csi(&input);
+  else
+    throw std::invalid_argument("Unknown index format " + index_file);
+
+  // keep chromosomes in file order
+  std::vector<std::pair<uint64_t, std::string>> order;
+  for (auto &offset : offsets) order.emplace_back(offset.second, offset.first);
+  std::sort(order.begin(), order.end());
+  for (auto &entry : order) chromosomes.push_back(entry.second);
+}
+
+std::string VCF_Index::find(const std::string &vcf_file) {
+  for (const char *extension : {".tbi", ".csi"})
+    if (file_exists(vcf_file + extension)) return vcf_file + extension;
+  return "";
+}
+
+uint64_t VCF_Index::getOffset(const std::string &chromosome) const {
+  auto it = offsets.find(chromosome);
+  if (it == offsets.end())
+    throw std::invalid_argument("Chromosome '" + chromosome +
+                                "' not found in index");
+  return it->second;
+}
+
+std::vector<std::string> VCF_Index::read_names(std::istream *input) {
+  // tabix header: format, col_seq, col_beg, col_end, meta, skip
+  for (int i = 0; i < 6; ++i) read_int(input);
+  int32_t length = read_int(input);
+  std::string names(length, '\0');
+  if (length > 0 && !input->read(&names[0], length))
+    throw std::invalid_argument("Truncated vcf index");
+
+  // names are null terminated and concatenated
+  std::vector<std::string> result;
+  std::string::size_type start = 0;
+  while (start < names.size()) {
+    std::string::size_type end = names.find('\0', start);
+    if (end == std::string::npos) end = names.size();
+    result.push_back(names.substr(start, end - start));
+    start = end + 1;
+  }
+  return result;
+}
+
+void VCF_Index::add_reference(const std::string &name, uint64_t offset) {
+  if (offset != std::numeric_limits<uint64_t>::max()) offsets[name] = offset;
+}
+
+void VCF_Index::read_tabix(std::istream *input) {
+  int32_t references = read_int(input);
+  std::vector<std::string> names = read_names(input);
+  if (static_cast<int32_t>(names.size()) != references)
+    throw std::invalid_argument("Mismatched names in vcf index");
+
+  for (auto &name : names) {
+    // first record is the smallest chunk start
+    uint64_t first = std::numeric_limits<uint64_t>::max();
+    int32_t bins = read_int(input);
+    for (int32_t i = 0; i < bins; ++i) {
+      uint32_t bin = read_value<uint32_t>(input);
+      int32_t chunks = read_int(input);
+      for (int32_t j = 0; j < chunks; ++j) {
+        uint64_t begin = read_value<uint64_t>(input);
+        read_value<uint64_t>(input);  // end
+        if (bin != TABIX_PSEUDO_BIN) first = std::min(first, begin);
+      }
+    }
+    // linear index is not needed
+    int32_t intervals = read_int(input);
+    for (int32_t i = 0; i < intervals; ++i) read_value<uint64_t>(input);
+    add_reference(name, first);
+  }
+}
+
+void VCF_Index::read_csi(std::istream *input) {
+  read_int(input);  // min_shift
+  int32_t depth = read_int(input);
+  uint32_t pseudo_bin = ((1u << ((depth + 1) * 3)) - 1) / 7 + 1;
+
+  // names are stored in the auxiliary data using the tabix layout
+  int32_t aux_length = read_int(input);
+  std::string aux(aux_length, '\0');
+  if (aux_length > 0 && !input->read(&aux[0], aux_length))
+    throw std::invalid_argument("Truncated vcf index");
+  if (aux_length == 0)
+    throw std::invalid_argument("csi index does not contain sequence names");
+  std::istringstream aux_stream(aux);
+  std::vector<std::string> names = read_names(&aux_stream);
+
+  int32_t references = read_int(input);
+  if (static_cast<int32_t>(names.size()) != references)
+    throw std::invalid_argument("Mismatched names in vcf index");
+
+  for (auto &name : names) {
+    uint64_t first = std::numeric_limits<uint64_t>::max();
+    int32_t bins = read_int(input);
+    for (int32_t i = 0; i < bins; ++i) {
+      uint32_t bin = read_value<uint32_t>(input);
+      read_value<uint64_t>(input);  // loffset
+      int32_t chunks = read_int(input);
+      for (int32_t j = 0; j < chunks; ++j) {
+        uint64_t begin = read_value<uint64_t>(input);
+        read_value<uint64_t>(input);  // end
+        if (bin != pseudo_bin) first = std::min(first, begin);
+      }
+    }
+    add_reference(name, first);
+  }
+}
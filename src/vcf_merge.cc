@@ -0,0 +1,114 @@
+#include "IBDmix/vcf_merge.h"
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <set>
+#include <stdexcept>
+#include <utility>
+
+#include "IBDmix/vcf_pipeline.h"
+
+template <typename File>
+void merge_vcfs(File *archaic, const std::vector<File *> &moderns,
+                const std::vector<bool> &has_records, Genotype_Writer *output) {
+  typedef std::pair<uint64_t, size_t> Entry;
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+  for (size_t i = 0; i < moderns.size(); ++i)
+    if (has_records[i] && moderns[i]->update())
+      heap.emplace(moderns[i]->getPosition(), i);
+
+  std::vector<const std::string *> genotypes(moderns.size() + 1);
+  std::vector<size_t> current;
+  bool recheck = false;
+  // for each position in the modern files
+  while (!heap.empty()) {
+    uint64_t position = heap.top().first;
+    current.clear();
+    while (!heap.empty() && heap.top().first == position) {
+      current.push_back(heap.top().second);
+      heap.pop();
+    }
+
+    // short update with recheck for case when archaic position is > modern
+    while (recheck || archaic->update(true)) {
+      recheck = false;
+      genotypes[0] = &archaic->getGenotypes();
+      for (size_t i = 0; i < moderns.size(); ++i)
+        genotypes[i + 1] = &moderns[i]->getBlank();
+
+      // less than position, copy archaic and use modern blank lines
+      if (archaic->getPosition() < position) {
+        // skip lines with no informative archaic GT
+        if (archaic->isInformative()) {
+          // output archaic information and blank modern
+          output->writeSite(archaic->getChromosome(), archaic->getPosition(),
+                            archaic->getReference(),
+                            archaic->getAlternative(), genotypes);
+        }
+        // equal, have to check other conditions to write
+      } else if (archaic->getPosition() == position) {
+        // check alleles are matching, the first matching cohort sets alt
+        char alternative = archaic->getAlternative();
+        bool matched = false;
+        for (size_t i : current) {
+          File *modern = moderns[i];
+          if (modern->isValid() &&
+              archaic->getChromosome() == modern->getChromosome() &&
+              archaic->getReference() == modern->getReference() &&
+              (alternative == '.' ||
+               alternative == modern->getAlternative())) {
+            alternative = modern->getAlternative();
+            genotypes[i + 1] = &modern->getGenotypes();
+            matched = true;
+          }
+        }
+        if (matched)
+          output->writeSite(archaic->getChromosome(), archaic->getPosition(),
+                            archaic->getReference(), alternative, genotypes);
+        // advance both to match legacy version
+        break;
+        // greater than, advance modern but keep archaic where it is
+      } else {
+        recheck = true;
+        break;
+      }
+    }
+
+    for (size_t i : current)
+      if (moderns[i]->update()) heap.emplace(moderns[i]->getPosition(), i);
+  }
+}
+
+template void merge_vcfs(VCF_File *archaic,
+                         const std::vector<VCF_File *> &moderns,
+                         const std::vector<bool> &has_records,
+                         Genotype_Writer *output);
+template void merge_vcfs(Pipelined_VCF_File *archaic,
+                         const std::vector<Pipelined_VCF_File *> &moderns,
+                         const std::vector<bool> &has_records,
+                         Genotype_Writer *output);
+
+std::vector<std::string> read_subset(const std::string &sample_file) {
+  std::vector<std::string> result;
+  if (sample_file.empty()) return result;
+  std::ifstream sample(sample_file);
+  std::string name;
+  while (sample >> name) result.push_back(name);
+  if (result.empty())
+    throw std::invalid_argument("No samples in " + sample_file);
+  return result;
+}
+
+void check_subset(const std::vector<std::string> &subset,
+                  const std::vector<std::unique_ptr<VCF_File>> &moderns) {
+  // every requested sample must be in one of the modern files
+  std::set<std::string> found;
+  for (auto &modern : moderns)
+    found.insert(modern->getSamples().begin(), modern->getSamples().end());
+  for (auto &sample : subset)
+    if (found.count(sample) == 0)
+      throw std::invalid_argument("Sample '" + sample +
+                                  "' not found in modern vcfs");
+}
@@ -0,0 +1,154 @@
+#include "IBDmix/vcf_pipeline.h"
+
+#include <utility>
+
+Pipelined_VCF_File::Pipelined_VCF_File(VCF_File *file,
+                                       bool skip_non_informative)
+    : file(file),
+      skip_non_informative(skip_non_informative),
+      blank_line(file->getBlank()),
+      count(file->getCount()),
+      full(PIPELINE_BATCHES),
+      empty(PIPELINE_BATCHES) {
+  for (int i = 0; i < PIPELINE_BATCHES; ++i) {
+    std::unique_ptr<Batch> batch(new Batch);
+    batch->records.resize(PIPELINE_BATCH_LINES);
+    empty.try_push(std::move(batch));
+  }
+  reader = std::thread(&Pipelined_VCF_File::read, this);
+}
+
+Pipelined_VCF_File::~Pipelined_VCF_File() {
+  stopping = true;
+  full.wake();
+  empty.wake();
+  reader.join();
+}
+
+void Pipelined_VCF_File::read() {
+  std::unique_ptr<Batch> batch;
+  bool last = false;
+  while (!last) {
+    if (!empty.pop(&batch, stopping)) return;
+    batch->size = 0;
+    try {
+      while (batch->size < batch->records.size()) {
+        if (!file->update(skip_non_informative)) {
+          last = true;
+          break;
+        }
+        Record &record = batch->records[batch->size++];
+        record.chromosome = file->getChromosome();
+        record.position = file->getPosition();
+        record.valid = file->isValid();
+        // genotypes are not parsed for invalid lines
+        if (!record.valid) continue;
+        record.reference = file->getReference();
+        record.alternative = file->getAlternative();
+        record.genotypes = file->getGenotypes();
+      }
+    } catch (...) {
+      batch->error = std::current_exception();
+      last = true;
+    }
+    batch->last = last;
+    if (!full.push(std::move(batch), stopping)) return;
+  }
+}
+
+bool Pipelined_VCF_File::update(bool) {
+  if (batch && ++index < batch->size) return true;
+  for (;;) {
+    if (batch) {
+      if (batch->last) {
+        // stay on the end of the file
+        index = batch->size;
+        return false;
+      }
+      empty.try_push(std::move(batch));
+    }
+    full.pop(&batch);
+    if (batch->error) {
+      batch->last = true;
+      batch->size = 0;
+      std::rethrow_exception(batch->error);
+    }
+    index = 0;
+    if (batch->size > 0) return true;
+  }
+}
+
+Pipelined_Genotype_Writer::Pipelined_Genotype_Writer(Genotype_Writer *writer)
+    : Genotype_Writer(writer->getOutput(), writer->getSamples()),
+      writer(writer),
+      full(PIPELINE_BATCHES),
+      empty(PIPELINE_BATCHES) {
+  for (int i = 0; i < PIPELINE_BATCHES; ++i) {
+    std::unique_ptr<Batch> batch(new Batch);
+    batch->sites.resize(PIPELINE_BATCH_LINES);
+    empty.try_push(std::move(batch));
+  }
+  thread = std::thread(&Pipelined_Genotype_Writer::write, this);
+}
+
+Pipelined_Genotype_Writer::~Pipelined_Genotype_Writer() {
+  if (!finished) {
+    send(true);
+    thread.join();
+  }
+}
+
+void Pipelined_Genotype_Writer::writeHeader() { writer->writeHeader(); }
+
+void Pipelined_Genotype_Writer::writeSite(
+    const std::string &chromosome, uint64_t position, char reference,
+    char alternative, const std::vector<const std::string *> &genotypes) {
+  if (!batch) empty.pop(&batch);
+  Site &site = batch->sites[batch->size++];
+  site.chromosome = chromosome;
+  site.position = position;
+  site.reference = reference;
+  site.alternative = alternative;
+  site.genotypes.clear();
+  for (auto genotype : genotypes) site.genotypes += *genotype;
+  if (batch->size == batch->sites.size()) send(false);
+}
+
+void Pipelined_Genotype_Writer::finish() {
+  if (finished) return;
+  send(true);
+  thread.join();
+  finished = true;
+  if (error) std::rethrow_exception(error);
+  writer->flush();
+}
+
+void Pipelined_Genotype_Writer::send(bool last) {
+  if (!batch) empty.pop(&batch);
+  batch->last = last;
+  full.push(std::move(batch));
+  batch.reset();
+}
+
+void Pipelined_Genotype_Writer::write() {
+  std::unique_ptr<Batch> batch;
+  std::vector<const std::string *> genotypes(1);
+  for (;;) {
+    full.pop(&batch);
+    try {
+      if (!error)
+        for (size_t i = 0; i < batch->size; ++i) {
+          Site &site = batch->sites[i];
+          genotypes[0] = &site.genotypes;
+          writer->writeSite(site.chromosome, site.position, site.reference,
+                            site.alternative, genotypes);
+        }
+    } catch (...) {
+      error = std::current_exception();
+    }
+    bool last = batch->last;
+    batch->size = 0;
+    empty.try_push(std::move(batch));
+    if (last) return;
+  }
+}
@@ -0,0 +1,68 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "IBDmix/Frequency_Reader.h"
+
+TEST(FrequencyReader, CanFindSites) {
+  std::istringstream input(
+      "#chrom\tpos\tAF\tAN\n"
+      "1\t100\t0.25\t200\n"
+      "1\t120\t0.5\n"
+      "1\t130\t0\t10\n"
+      "\n"
+      "2\t90\t1\t20\n"
+      "4\t10\t0.125\t8\n");
+  Frequency_Reader reader(&input);
+  double frequency = -1;
+  int allele_number = -1;
+
+  ASSERT_FALSE(reader.find("1", 90, &frequency, &allele_number));
+  ASSERT_EQ(-1, frequency);
+  ASSERT_TRUE(reader.find("1", 100, &frequency, &allele_number));
+  ASSERT_EQ(0.25, frequency);
+  ASSERT_EQ(200, allele_number);
+  // same position again
+  ASSERT_TRUE(reader.find("1", 100, &frequency, &allele_number));
+
+  ASSERT_FALSE(reader.find("1", 110, &frequency, &allele_number));
+  ASSERT_TRUE(reader.find("1", 120, &frequency, &allele_number));
+  ASSERT_EQ(0.5, frequency);
+  ASSERT_EQ(0, allele_number);
+
+  // skip the rest of a chromosome and a missing chromosome
+  ASSERT_TRUE(reader.find("2", 90, &frequency, &allele_number));
+  ASSERT_EQ(1, frequency);
+  ASSERT_EQ(20, allele_number);
+  ASSERT_FALSE(reader.find("3", 10, &frequency, &allele_number));
+  ASSERT_TRUE(reader.find("4", 10, &frequency, &allele_number));
+  ASSERT_EQ(0.125, frequency);
+
+  // end of file
+  ASSERT_FALSE(reader.find("4", 11, &frequency, &allele_number));
+  ASSERT_FALSE(reader.find("5", 10, &frequency, &allele_number));
+}
+
+TEST(FrequencyReader, CanSkipNull) {
+  Frequency_Reader reader(nullptr);
+  double frequency;
+  int allele_number;
+  ASSERT_FALSE(reader.find("1", 100, &frequency, &allele_number));
+}
+
+TEST(FrequencyReader, ThrowsOnBadLine) {
+  std::istringstream input(
+      "1\t100\t0.25\n"
+      "1\t120\t1.5\n");
+  Frequency_Reader reader(&input);
+  double frequency;
+  int allele_number;
+  ASSERT_THROW(reader.find("1", 120, &frequency, &allele_number),
+               std::invalid_argument);
+
+  std::istringstream text("1\tpos\t0.25\n");
+  ASSERT_THROW(Frequency_Reader bad(&text), std::invalid_argument);
+}
@@ -2,6 +2,8 @@
 #include <gtest/gtest.h>
 
 #include <iostream>
+#include <sstream>
+#include <string>
 
 #include "IBDmix/Genotype_Reader.h"
 
@@ -135,6 +137,7 @@ TEST_F(SampleGenotype, CanUpdateDefaults) {
   // "1\t2\tA\tT\t1\t0\t0\t0\t0\n"  fails allele check
   ASSERT_TRUE(reader.update());
   ASSERT_EQ("1", reader.getChromosome());
+  ASSERT_EQ(0, reader.getChromosomeId());
   ASSERT_EQ(2, reader.getPosition());
   ASSERT_DOUBLE_EQ(0, reader.getLodScore(0));
   ASSERT_DOUBLE_EQ(0, reader.getLodScore(1));
@@ -180,6 +183,7 @@ TEST_F(SampleGenotype, CanUpdateDefaults) {
   // "2\t125\tA\tT\t0\t2\t2\t1\t1\n" change chromosome
   ASSERT_TRUE(reader.update());
   ASSERT_EQ("2", reader.getChromosome());
+  ASSERT_EQ(1, reader.getChromosomeId());
   ASSERT_EQ(125, reader.getPosition());
   ASSERT_TRUE(abs((reader.getLodScore(0) - -1.79301) / -1.79301) < 0.001);
   ASSERT_TRUE(abs((reader.getLodScore(1) - -1.79301) / -1.79301) < 0.001);
@@ -189,7 +193,10 @@ TEST_F(SampleGenotype, CanUpdateDefaults) {
   // "3\t126\tA\tT\t0\t2\t2\t2\t2\n" change chrom, 0/2 override check
   ASSERT_TRUE(reader.update());
   ASSERT_EQ("3", reader.getChromosome());
+  ASSERT_EQ(2, reader.getChromosomeId());
   ASSERT_EQ(126, reader.getPosition());
+  ASSERT_EQ(3, reader.getChromosomes().size());
+  ASSERT_EQ("2", reader.getChromosomes().name(1));
   ASSERT_TRUE(abs((reader.getLodScore(0) - -1.99568) / -1.99568) < 0.001);
   ASSERT_TRUE(abs((reader.getLodScore(1) - -1.99568) / -1.99568) < 0.001);
   ASSERT_TRUE(abs((reader.getLodScore(2) - -1.99568) / -1.99568) < 0.001);
@@ -440,3 +447,123 @@ TEST_F(SampleGenotype, CanCheckLineFilter) {
   // eof
   ASSERT_FALSE(reader.update());
 }
+
+TEST_F(SampleGenotype, CanUpdateBlock) {
+  std::istringstream expected_genotype(genotype.str()),
+      expected_mask(mask.str());
+  Genotype_Reader expected(&expected_genotype, &expected_mask);
+  Genotype_Reader reader(&genotype, &mask);
+  std::istringstream expected_samples("m4\nm1\nm3"), samples("m4\nm1\nm3");
+  expected.initialize(expected_samples);
+  reader.initialize(samples);
+
+  Genotype_Block block;
+  reader.initialize_block(&block, 3);
+  ASSERT_EQ(3, block.capacity);
+  ASSERT_EQ(3, block.samples);
+
+  // blocks of 3, 3 and 1 sites
+  for (int expected_sites : {3, 3, 1}) {
+    ASSERT_EQ(expected_sites, reader.update(&block));
+    ASSERT_EQ(expected_sites, block.sites);
+    for (int site = 0; site < block.sites; ++site) {
+      ASSERT_TRUE(expected.update());
+      ASSERT_EQ(expected.getChromosomeId(), block.chromosomes[site]);
+      ASSERT_EQ(expected.getChromosome(),
+                reader.getChromosomes().name(block.chromosomes[site]));
+      ASSERT_EQ(expected.getPosition(), block.positions[site]);
+      for (int sample = 0; sample < block.samples; ++sample) {
+        ASSERT_EQ(expected.getLodScore(sample), block.getLods(sample)[site]);
+        ASSERT_EQ(expected.getLineFilter() | expected.getRecoverType(sample),
+                  block.getBitmasks(sample)[site]);
+      }
+    }
+    // single site getters are for the last site
+    ASSERT_EQ(expected.getPosition(), reader.getPosition());
+  }
+  ASSERT_EQ(0, reader.update(&block));
+  ASSERT_FALSE(expected.update());
+}
+
+TEST_F(SampleGenotype, CanLimitBlock) {
+  Genotype_Reader reader(&genotype);
+  std::istream sample_dummy(nullptr);
+  reader.initialize(sample_dummy);
+  Genotype_Block block;
+  reader.initialize_block(&block);
+  ASSERT_EQ(GENOTYPE_BLOCK_SITES, block.capacity);
+  ASSERT_EQ(4 * GENOTYPE_BLOCK_SITES, block.lods.size());
+
+  std::string header = "chrom\tpos\tref\talt\tn1";
+  for (int i = 0; i < 2048; ++i) header += "\tm" + std::to_string(i);
+  std::istringstream wide(header + "\n");
+  Genotype_Reader wide_reader(&wide);
+  wide_reader.initialize(sample_dummy);
+  wide_reader.initialize_block(&block);
+  ASSERT_EQ(GENOTYPE_BLOCK_ENTRIES / 2048, block.capacity);
+  ASSERT_EQ(0, wide_reader.update(&block));
+}
+
+TEST_F(SampleGenotype, CanUseFrequencyFile) {
+  // sites missing from the file use the frequency of the samples
+  std::istringstream frequencies(
+      "1\t2\t0.5\t100\n"
+      "1\t3\t0.01\t100\n"
+      "1\t4\t0.25\n"
+      "1\t105\t0\n"
+      "3\t126\t0.3\t10\n");
+  std::istringstream expected_genotype(genotype.str());
+  Genotype_Reader expected(&expected_genotype);
+  Genotype_Reader reader(&genotype, nullptr, 0.01, 0.0025, 2, 1e-200, 1,
+                         &frequencies);
+  std::istringstream expected_samples("m2"), samples("m2");
+  expected.initialize(expected_samples);
+  reader.initialize(samples);
+  LodCalculator calculator(0.01, 0.0025, 2, 1e-200);
+
+  // "1\t2\tA\tT\t1\t0\t0\t0\t0\n" passes with the file frequency
+  ASSERT_TRUE(reader.update());
+  ASSERT_EQ(0, reader.getLineFilter());
+  ASSERT_EQ(0.5, reader.getAlleleFrequency());
+  calculator.update_lod_cache('1', 0.5);
+  ASSERT_EQ(calculator.calculate_lod('0'), reader.getLodScore(0));
+
+  // "1\t3\tA\tT\t2\t0\t0\t0\t0\n" 1 alt allele of 100
+  ASSERT_TRUE(reader.update());
+  ASSERT_EQ(MAF_LOW, reader.getLineFilter());
+  ASSERT_EQ(0.01, reader.getAlleleFrequency());
+  ASSERT_EQ(RECOVER_2_0, reader.getRecoverType(0));
+
+  // "1\t4\tA\tT\t1\t0\t1\t1\t1\n" no allele number
+  ASSERT_TRUE(reader.update());
+  ASSERT_EQ(0, reader.getLineFilter());
+  ASSERT_EQ(0.25, reader.getAlleleFrequency());
+  calculator.update_lod_cache('1', 0.25);
+  ASSERT_EQ(calculator.calculate_lod('1'), reader.getLodScore(0));
+
+  // "1\t104\tA\tT\t1\t0\t1\t1\t1\n" not in the file
+  for (int i = 0; i < 4; ++i) ASSERT_TRUE(expected.update());
+  ASSERT_TRUE(reader.update());
+  ASSERT_EQ(expected.getLineFilter(), reader.getLineFilter());
+  ASSERT_EQ(expected.getAlleleFrequency(), reader.getAlleleFrequency());
+  ASSERT_EQ(expected.getLodScore(0), reader.getLodScore(0));
+
+  // "1\t105\tA\tT\t0\t2\t1\t1\t1\n" monomorphic
+  ASSERT_TRUE(reader.update());
+  ASSERT_EQ(MAF_LOW, reader.getLineFilter());
+  ASSERT_EQ(0, reader.getAlleleFrequency());
+
+  // "2\t125\tA\tT\t0\t2\t2\t1\t1\n" not in the file
+  ASSERT_TRUE(expected.update());
+  ASSERT_TRUE(expected.update());
+  ASSERT_TRUE(reader.update());
+  ASSERT_EQ(expected.getLineFilter(), reader.getLineFilter());
+  ASSERT_EQ(expected.getLodScore(0), reader.getLodScore(0));
+
+  // "3\t126\tA\tT\t0\t2\t2\t2\t2\n" 3 alt alleles of 10
+  ASSERT_TRUE(reader.update());
+  ASSERT_EQ(0, reader.getLineFilter());
+  calculator.update_lod_cache('0', 0.3);
+  ASSERT_EQ(calculator.calculate_lod('2'), reader.getLodScore(0));
+  ASSERT_FALSE(reader.update());
+}
@@ -0,0 +1,128 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <utility>
+
+#include "IBDmix/IBD_Array_Stack.h"
+
+TEST(IBDArrayStack, CanAdvance) {
+  IBD_Array_Stack stack;
+  ASSERT_TRUE(stack.empty());
+  stack.push(1, 2, 0);
+  stack.push(2, -1, 3);
+  ASSERT_TRUE(stack.empty());
+  ASSERT_TRUE(stack.hasPending());
+
+  stack.advance();
+  ASSERT_TRUE(stack.isSingleton());
+  ASSERT_TRUE(stack.topIsEnd());
+  ASSERT_EQ(1, stack.startPosition());
+  stack.advance();
+  ASSERT_FALSE(stack.hasPending());
+  ASSERT_EQ(2, stack.size());
+  ASSERT_FALSE(stack.topIsNewMax());
+  ASSERT_EQ(1, stack.getNode(stack.getTop()).cumulative_lod);
+  ASSERT_EQ(3, stack.getNode(stack.getTop()).bitmask);
+  // the node after end
+  ASSERT_EQ(2, stack.getPosition(stack.getEnd() + 1));
+}
+
+TEST(IBDArrayStack, CanSetEnd) {
+  IBD_Array_Stack stack;
+  for (double lod : {1.0, -0.5, 0.25, 1.0}) {
+    stack.push(stack.size() + 1, lod, 0);
+    stack.advance();
+  }
+  ASSERT_TRUE(stack.topIsNewMax());
+  stack.setEnd();
+  // start and end remain
+  ASSERT_EQ(2, stack.size());
+  ASSERT_EQ(1, stack.startPosition());
+  ASSERT_EQ(4, stack.endPosition());
+  ASSERT_DOUBLE_EQ(1.75, stack.endLod());
+
+  std::ostringstream output;
+  stack.write(output);
+  ASSERT_EQ("4\t1\t1.75 <- top <- end\n1\t1\t1 <- start\n", output.str());
+}
+
+TEST(IBDArrayStack, CanClear) {
+  IBD_Array_Stack stack;
+  for (double lod : {1.0, -0.5, 0.25, -2.0}) {
+    stack.push(stack.size() + 1, lod, 0);
+    stack.advance();
+  }
+  ASSERT_TRUE(stack.reachedMax());
+  stack.clear();
+  // nodes after end are pending again
+  ASSERT_TRUE(stack.empty());
+  ASSERT_EQ(0, stack.size());
+  ASSERT_TRUE(stack.hasPending());
+  ASSERT_EQ(-0.5, stack.pendingLod());
+  stack.dropPending();
+  ASSERT_EQ(0.25, stack.pendingLod());
+  stack.advance();
+  ASSERT_EQ(3, stack.startPosition());
+  ASSERT_EQ(-2.0, stack.pendingLod());
+}
+
+TEST(IBDArrayStack, CanExtend) {
+  IBD_Array_Stack stack;
+  ASSERT_FALSE(stack.canExtend(0));
+  stack.push(1, 1, 0);
+  stack.advance();
+  stack.push(2, 0, 0);
+  stack.advance();
+  // the first site of a run is a node
+  ASSERT_FALSE(stack.canExtend(0));
+  stack.push(3, 0, 0);
+  stack.advance();
+  ASSERT_TRUE(stack.canExtend(0));
+  ASSERT_FALSE(stack.canExtend(3));
+  stack.extend(4);
+  stack.extend(5);
+  ASSERT_EQ(3, stack.size());
+  IBD_Node node = stack.getNode(stack.getTop());
+  ASSERT_EQ(5, node.position);
+  ASSERT_EQ(3, node.sites);
+  ASSERT_EQ(1, node.cumulative_lod);
+
+  ASSERT_TRUE(stack.topIsNewMax());
+  stack.setEnd();
+  ASSERT_EQ(5, stack.endPosition());
+  stack.push(6, -2, 0);
+  stack.advance();
+  ASSERT_FALSE(stack.canExtend(0));
+}
+
+TEST(IBDArrayStack, CanCompact) {
+  // a long segment keeps a bounded number of nodes
+  IBD_Array_Stack stack;
+  for (int i = 1; i <= 100000; ++i) {
+    stack.push(i, i % 2 == 0 ? -1.0 : 2.0, 0);
+    stack.advance();
+    if (stack.topIsNewMax()) stack.setEnd();
+    ASSERT_LE(stack.size(), 3);
+  }
+  ASSERT_EQ(1, stack.startPosition());
+  ASSERT_EQ(99999, stack.endPosition());
+  ASSERT_DOUBLE_EQ(50001, stack.endLod());
+}
+
+TEST(IBDArrayStack, CanMove) {
+  // inline and allocated arrays
+  for (int nodes : {2, 20}) {
+    IBD_Array_Stack stack;
+    for (int i = 1; i <= nodes; ++i) {
+      stack.push(i, -1, 0);
+      stack.advance();
+    }
+    IBD_Array_Stack moved(std::move(stack));
+    ASSERT_TRUE(stack.empty());
+    ASSERT_EQ(nodes, moved.size());
+    ASSERT_EQ(1, moved.startPosition());
+    ASSERT_EQ(nodes, moved.getPosition(moved.getTop()));
+    ASSERT_EQ(-nodes, moved.getNode(moved.getTop()).cumulative_lod);
+  }
+}
@@ -0,0 +1,107 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "IBDmix/Genotype_Reader.h"
+#include "IBDmix/IBD_Collection.h"
+#include "IBDmix/IBD_Segment.h"
+#include "IBDmix/Segment_Recorders.h"
+
+class CollectionGenotype : public ::testing::Test {
+ protected:
+  void SetUp() {
+    // modern samples share runs of the archaic genotype to form regions.
+    // More than 64 samples span several words of sample bits
+    std::ostringstream strm;
+    strm << "chrom\tpos\tref\talt\tarchaic";
+    for (int i = 0; i < samples; ++i) strm << "\tm" << i;
+    strm << '\n';
+    uint64_t state = 1;
+    for (int i = 1; i <= 3000; ++i) {
+      state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+      int archaic = (state >> 33) % 3;
+      strm << (i <= 1000 ? "1" : i <= 2200 ? "2" : "3") << '\t' << i
+           << "\tA\tT\t" << archaic;
+      for (int j = 0; j < samples; ++j) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        bool shared = ((i / (50 + 10 * j)) + j) % 3 == 0;
+        strm << '\t' << (shared ? archaic : (state >> 33) % 3);
+      }
+      strm << '\n';
+    }
+    contents = strm.str();
+  }
+
+  // regions of all samples updating site by site or by blocks of sites
+  std::string find_regions(int threads, bool blocks) {
+    std::istringstream input(contents);
+    std::istream samples(nullptr);
+    Genotype_Reader reader(&input);
+    reader.initialize(samples);
+    IBD_Collection ibds(1, true, threads);
+    ibds.initialize(reader);
+    ibds.add_recorder(IBD_Collection::Recorder::counts);
+    ibds.add_recorder(IBD_Collection::Recorder::sites);
+
+    std::ostringstream output;
+    if (blocks) {
+      Genotype_Block block;
+      reader.initialize_block(&block, 64);
+      while (reader.update(&block)) ibds.update(block, output);
+    } else {
+      while (reader.update()) ibds.update(reader, output);
+    }
+    ibds.purge(output);
+    return output.str();
+  }
+
+  // regions adding every site to every sample
+  std::string find_regions_directly() {
+    std::istringstream input(contents);
+    std::istream sample_names(nullptr);
+    Genotype_Reader reader(&input);
+    reader.initialize(sample_names);
+    std::vector<IBD_Segment> segments;
+    for (const std::string &name : reader.get_samples()) {
+      segments.emplace_back(name, 1, &reader.getChromosomes());
+      segments.back().add_recorder(std::make_shared<CountRecorder>());
+      segments.back().add_recorder(std::make_shared<SiteRecorder>());
+    }
+
+    std::ostringstream output;
+    while (reader.update())
+      for (int i = 0; i < samples; ++i)
+        segments[i].add_lod(reader.getChromosomeId(), reader.getPosition(),
+                            reader.getLodScore(i),
+                            reader.getLineFilter() | reader.getRecoverType(i),
+                            output);
+    for (auto &segment : segments) segment.purge(output);
+    return output.str();
+  }
+
+  const int samples = 70;
+  std::string contents;
+};
+
+TEST_F(CollectionGenotype, ThreadsMatchSerial) {
+  std::string expected = find_regions(1, false);
+  // regions on each chromosome
+  ASSERT_THAT(expected, ::testing::HasSubstr("\t1\t"));
+  ASSERT_THAT(expected, ::testing::HasSubstr("\t3\t"));
+  ASSERT_EQ(expected, find_regions(1, true));
+  for (int threads : {2, 3, 5, 13, 20})
+    ASSERT_EQ(expected, find_regions(threads, true)) << threads;
+}
+
+TEST_F(CollectionGenotype, SkippingSamplesMatchesAllSamples) {
+  // samples without a region are only visited for a lod of at least 0
+  std::string expected = find_regions_directly();
+  ASSERT_EQ(expected, find_regions(1, false));
+  ASSERT_EQ(expected, find_regions(1, true));
+  ASSERT_EQ(expected, find_regions(3, true));
+}
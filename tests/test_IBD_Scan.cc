@@ -0,0 +1,74 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "IBDmix/IBD_Scan.h"
+
+TEST(IBDScan, CanAdd) {
+  IBD_Scan scan;
+  ASSERT_TRUE(scan.empty());
+  ASSERT_FALSE(scan.add(1, -1));
+  ASSERT_TRUE(scan.empty());
+
+  for (double lod : {1.0, -0.5, 0.25, 1.0}) ASSERT_FALSE(scan.add(0, lod));
+  ASSERT_FALSE(scan.empty());
+  ASSERT_DOUBLE_EQ(1.75, scan.endLod());
+  ASSERT_FALSE(scan.hasTail());
+  ASSERT_EQ(2, scan.size());
+}
+
+TEST(IBDScan, CanWrite) {
+  IBD_Scan scan;
+  uint64_t position = 1;
+  for (double lod : {1.0, -0.5, 0.25, 1.0, -0.5}) scan.add(position++, lod);
+  // start, end and the node after end
+  ASSERT_EQ(3, scan.size());
+  std::ostringstream output;
+  scan.write(output);
+  ASSERT_EQ(
+      "5\t-0.5\t1.25 <- top\n"
+      "4\t1\t1.75 <- end\n"
+      "1\t1\t1 <- start\n",
+      output.str());
+}
+
+TEST(IBDScan, CanRestart) {
+  IBD_Scan scan;
+  uint64_t position = 1;
+  for (double lod : {1.0, -0.5, 0.25, 1.0})
+    ASSERT_FALSE(scan.add(position++, lod));
+  ASSERT_FALSE(scan.add(5, -1.5));
+  ASSERT_FALSE(scan.add(6, 1.0));
+  ASSERT_TRUE(scan.add(7, -2.0));
+  ASSERT_EQ(1, scan.startPosition());
+  ASSERT_EQ(4, scan.endPosition());
+  ASSERT_TRUE(scan.hasTail());
+  ASSERT_EQ(5, scan.tailPosition());
+
+  // 5 is dropped, 6 starts the next region and 7 completes it
+  scan.restart();
+  ASSERT_TRUE(scan.empty());
+  ASSERT_TRUE(scan.hasPending());
+  ASSERT_FALSE(scan.advance());
+  ASSERT_FALSE(scan.advance());
+  ASSERT_EQ(6, scan.startPosition());
+  ASSERT_TRUE(scan.advance());
+  ASSERT_FALSE(scan.hasPending());
+  ASSERT_DOUBLE_EQ(1.0, scan.endLod());
+  ASSERT_EQ(7, scan.tailPosition());
+}
+
+TEST(IBDScan, CanGrow) {
+  IBD_Scan scan;
+  scan.add(0, 100);
+  // a long tail after end, restarted from the buffer
+  for (uint64_t i = 1; i <= 100; ++i) ASSERT_FALSE(scan.add(i, -0.5));
+  ASSERT_EQ(101, scan.size());
+  for (uint64_t i = 101; i < 150; ++i) ASSERT_FALSE(scan.add(i, -1));
+  ASSERT_TRUE(scan.add(150, -2));
+  ASSERT_EQ(1, scan.tailPosition());
+  scan.restart();
+  while (scan.hasPending()) ASSERT_FALSE(scan.advance());
+  ASSERT_TRUE(scan.empty());
+}
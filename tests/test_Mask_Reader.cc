@@ -67,3 +67,29 @@ TEST(MaskReader, CanTestInMask) {
   Mask_Reader mask2(nullptr);
   ASSERT_FALSE(mask2.in_mask("1", 161));
 }
+
+TEST(MaskReader, CanTestInMaskWithIds) {
+  std::istringstream mask_input(
+      "1 100 120\n"
+      "1 130 140\n"
+      "2 130 140\n"
+      "4 130 140\n"
+      "4 150 160\n");
+
+  Mask_Reader mask(&mask_input);
+
+  // ids of 1, 2, 3, 4 and 5 as interned by a reader
+  ASSERT_FALSE(mask.in_mask(0, "1", 90));
+  ASSERT_TRUE(mask.in_mask(0, "1", 101));
+  ASSERT_TRUE(mask.in_mask(0, "1", 135));
+  ASSERT_FALSE(mask.in_mask(0, "1", 141));
+  ASSERT_FALSE(mask.in_mask(1, "2", 100));
+  ASSERT_TRUE(mask.in_mask(1, "2", 131));
+  ASSERT_FALSE(mask.in_mask(2, "3", 131));
+  ASSERT_FALSE(mask.in_mask(3, "4", 130));
+  ASSERT_TRUE(mask.in_mask(3, "4", 131));
+  ASSERT_FALSE(mask.in_mask(3, "4", 145));
+  ASSERT_TRUE(mask.in_mask(3, "4", 155));
+  ASSERT_FALSE(mask.in_mask(4, "5", 155));
+  ASSERT_FALSE(mask.in_mask(4, "5", 156));
+}
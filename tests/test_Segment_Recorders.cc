@@ -91,6 +91,27 @@ TEST(CountRecorder, CanRecord) {
   ASSERT_STREQ(oss.str().c_str(), "\t0\t0\t0\t0\t0\t0\t0\t0\t0");
 }
 
+TEST(CountRecorder, CanRecordRun) {
+  CountRecorder counter;
+  std::ostringstream oss;
+  IBD_Pool pool(5);
+  IBD_Node *node = pool.get_node(1, 0, IN_MASK | RECOVER_2_0);
+  node->sites = 3;
+
+  counter.initializeSegment();
+  counter.record(node);
+  counter.report(oss);
+  ASSERT_STREQ(oss.str().c_str(), "\t3\t0\t0\t0\t3\t0\t0\t3\t0");
+  oss.str("");
+  oss.clear();
+
+  node->lod = -1;
+  node->bitmask = MAF_LOW;
+  counter.record(node);
+  counter.report(oss);
+  ASSERT_STREQ(oss.str().c_str(), "\t6\t0\t3\t0\t3\t3\t0\t3\t0");
+}
+
 TEST(SiteRecorder, CanWriteHeader) {
   SiteRecorder counter;
   std::ostringstream oss;
@@ -0,0 +1,185 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "IBDmix/bgzf_streambuf.h"
+
+class CompressedFile : public ::testing::Test {
+ protected:
+  void SetUp() {
+    std::ostringstream strm;
+    for (int i = 0; i < 20000; ++i)
+      strm << "1\t" << i << "\t.\tA\tT\t.\tPASS\t.\tGT\t0|1\t1|1\n";
+    contents = strm.str();
+    filename = testing::TempDir() + "bgzf_test_" +
+               testing::UnitTest::GetInstance()->current_test_info()->name();
+  }
+
+  void TearDown() { std::remove(filename.c_str()); }
+
+  std::string read_all(int threads) {
+    BGZF_Streambuf buffer(filename, threads);
+    std::istream input(&buffer);
+    input.exceptions(std::ios::badbit);
+    std::ostringstream result;
+    std::string line;
+    while (std::getline(input, line)) result << line << '\n';
+    format = buffer.getFormat();
+    return result.str();
+  }
+
+  void write_gzip() {
+    gzFile file = gzopen(filename.c_str(), "wb");
+    // two members, as produced by cat a.gz b.gz
+    size_t half = contents.size() / 2;
+    gzwrite(file, contents.data(), half);
+    gzclose(file);
+    file = gzopen(filename.c_str(), "ab");
+    gzwrite(file, contents.data() + half, contents.size() - half);
+    gzclose(file);
+  }
+
+  void write_bgzf(size_t block_size) {
+    std::ofstream out(filename, std::ios::binary);
+    for (size_t start = 0; start < contents.size(); start += block_size)
+      write_block(&out, contents.substr(start, block_size));
+    write_block(&out, "");  // eof marker
+  }
+
+  void write_block(std::ofstream *out, const std::string &data) {
+    std::string deflated(compressBound(data.size()) + 64, '\0');
+    z_stream strm = {};
+    deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8,
+                 Z_DEFAULT_STRATEGY);
+    strm.next_in = (Bytef *)data.data();
+    strm.avail_in = data.size();
+    strm.next_out = (Bytef *)&deflated[0];
+    strm.avail_out = deflated.size();
+    deflate(&strm, Z_FINISH);
+    deflated.resize(strm.total_out);
+    deflateEnd(&strm);
+
+    uint32_t crc = crc32(0, (const Bytef *)data.data(), data.size());
+    uint32_t bsize = deflated.size() + 25;
+    unsigned char header[18] = {31, 139, 8, 4, 0, 0, 0, 0, 0, 255,
+                                6,  0,   'B', 'C', 2, 0,
+                                (unsigned char)(bsize & 0xff),
+                                (unsigned char)(bsize >> 8)};
+    out->write((const char *)header, 18);
+    *out << deflated;
+    write_le(out, crc);
+    write_le(out, data.size());
+  }
+
+  void write_le(std::ofstream *out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out->put((value >> (8 * i)) & 0xff);
+  }
+
+  std::string contents;
+  std::string filename;
+  BGZF_Streambuf::Format format;
+};
+
+TEST_F(CompressedFile, CanReadPlain) {
+  std::ofstream(filename) << contents;
+  ASSERT_EQ(read_all(1), contents);
+  ASSERT_EQ(format, BGZF_Streambuf::plain);
+}
+
+TEST_F(CompressedFile, CanReadGzip) {
+  write_gzip();
+  ASSERT_EQ(read_all(1), contents);
+  ASSERT_EQ(format, BGZF_Streambuf::gzip);
+  // threads are ignored for plain gzip
+  ASSERT_EQ(read_all(4), contents);
+}
+
+TEST_F(CompressedFile, CanReadBGZF) {
+  write_bgzf(65280);
+  ASSERT_EQ(read_all(1), contents);
+  ASSERT_EQ(format, BGZF_Streambuf::bgzf);
+  ASSERT_EQ(read_all(3), contents);
+}
+
+TEST_F(CompressedFile, CanReadSmallBlocks) {
+  // many blocks ending mid line
+  write_bgzf(1001);
+  ASSERT_EQ(read_all(1), contents);
+  ASSERT_EQ(read_all(2), contents);
+  ASSERT_EQ(read_all(8), contents);
+}
+
+TEST_F(CompressedFile, ThrowsOnTruncatedBGZF) {
+  write_bgzf(1001);
+  std::string data;
+  {
+    std::ifstream in(filename, std::ios::binary);
+    data.assign(std::istreambuf_iterator<char>(in),
+                std::istreambuf_iterator<char>());
+  }
+  std::ofstream(filename, std::ios::binary) << data.substr(0, data.size() / 2);
+  ASSERT_THROW(read_all(1), std::invalid_argument);
+  ASSERT_THROW(read_all(4), std::invalid_argument);
+}
+
+TEST_F(CompressedFile, CanSeekVirtualOffset) {
+  size_t block_size = 1001;
+  write_bgzf(block_size);
+  for (int threads : {1, 3}) {
+    BGZF_Streambuf buffer(filename, threads);
+    std::istream input(&buffer);
+    std::string line;
+    std::getline(input, line);
+
+    // find the virtual offset of a few lines, from the block sizes
+    std::ifstream raw(filename, std::ios::binary);
+    std::vector<uint64_t> block_starts;
+    uint64_t offset = 0;
+    while (offset < contents.size()) {
+      block_starts.push_back(raw.tellg());
+      char header[18];
+      raw.read(header, 18);
+      unsigned int bsize = static_cast<unsigned char>(header[16]) |
+                           static_cast<unsigned char>(header[17]) << 8;
+      raw.seekg(bsize + 1 - 18, std::ios::cur);
+      offset += block_size;
+    }
+
+    for (size_t line_start : {contents.find("\n1\t17\t"),
+                              contents.find("\n1\t9000\t"),
+                              contents.find("\n1\t3\t")}) {
+      ++line_start;
+      uint64_t virtual_offset = block_starts[line_start / block_size] << 16 |
+                                line_start % block_size;
+      buffer.seek(virtual_offset);
+      input.clear();
+      std::getline(input, line);
+      ASSERT_EQ(line + "\n",
+                contents.substr(line_start,
+                                contents.find('\n', line_start) -
+                                    line_start + 1));
+    }
+    // can read to the end after seeking
+    std::ostringstream rest;
+    rest << input.rdbuf();
+    ASSERT_EQ(rest.str(),
+              contents.substr(contents.find('\n', contents.find("\n1\t3\t") +
+                                                       1) +
+                              1));
+  }
+
+  // only bgzf supports seeking
+  std::ofstream(filename) << contents;
+  BGZF_Streambuf plain(filename);
+  ASSERT_THROW(plain.seek(0), std::invalid_argument);
+}
+
+TEST_F(CompressedFile, ThrowsOnMissingFile) {
+  ASSERT_THROW(BGZF_Streambuf("not/a/file.vcf.gz"), std::invalid_argument);
+}
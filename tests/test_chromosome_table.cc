@@ -0,0 +1,37 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "IBDmix/chromosome_table.h"
+
+TEST(ChromosomeTable, CanIntern) {
+  Chromosome_Table table;
+  ASSERT_EQ(0, table.size());
+  ASSERT_EQ(0, table.intern("1"));
+  ASSERT_EQ(1, table.intern("2"));
+  ASSERT_EQ(0, table.intern("1"));
+  ASSERT_EQ(2, table.intern("chrX"));
+  ASSERT_EQ(1, table.intern("2"));
+  ASSERT_EQ(3, table.size());
+  ASSERT_EQ("1", table.name(0));
+  ASSERT_EQ("2", table.name(1));
+  ASSERT_EQ("chrX", table.name(2));
+  ASSERT_THROW(table.name(3), std::invalid_argument);
+  ASSERT_THROW(table.name(-1), std::invalid_argument);
+}
+
+TEST(ChromosomeTable, CanLookupWhileInterning) {
+  Chromosome_Table table;
+  const std::string &first = table.name(table.intern("first"));
+  std::thread reader([&table] {
+    for (int i = 0; i < 1000; ++i) table.intern(std::to_string(i));
+  });
+  for (int i = 0; i < 1000; ++i) ASSERT_EQ("first", table.name(0));
+  reader.join();
+  // references are not invalidated by later names
+  ASSERT_EQ("first", first);
+  ASSERT_EQ("999", table.name(1000));
+}
@@ -0,0 +1,82 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "IBDmix/genotype_format.h"
+#include "IBDmix/genotype_pipeline.h"
+
+class PipelineGenotype : public ::testing::Test {
+ protected:
+  void SetUp() {
+    std::ostringstream strm;
+    strm << "chrom\tpos\tref\talt\tn1\tm1\tm2\tm3\n";
+    for (int i = 1; i <= 1000; ++i) {
+      strm << (i < 600 ? "1" : "2") << '\t' << i << "\tA\tT\t" << i % 3
+           << '\t' << i % 2 << '\t' << (i % 5 == 0 ? 9 : 2) << '\t'
+           << (i % 7) % 3 << '\n';
+    }
+    contents = strm.str();
+  }
+
+  std::string contents;
+};
+
+TEST_F(PipelineGenotype, MatchesReader) {
+  std::istringstream expected_input(contents), pipelined_input(contents);
+  std::istream sample_dummy(nullptr);
+  Genotype_Reader expected(&expected_input), reader(&pipelined_input);
+  expected.initialize(sample_dummy);
+  reader.initialize(sample_dummy);
+
+  Pipelined_Genotype_Reader pipelined(&reader, 64);
+  int sites = 0;
+  while (const Genotype_Block *block = pipelined.update()) {
+    ASSERT_EQ(3, block->samples);
+    for (int site = 0; site < block->sites; ++site) {
+      ASSERT_TRUE(expected.update());
+      ASSERT_EQ(expected.getChromosome(),
+                reader.getChromosomes().name(block->chromosomes[site]));
+      ASSERT_EQ(expected.getPosition(), block->positions[site]);
+      for (int i = 0; i < 3; ++i) {
+        ASSERT_EQ(expected.getLodScore(i), block->getLods(i)[site]);
+        ASSERT_EQ(expected.getLineFilter() | expected.getRecoverType(i),
+                  block->getBitmasks(i)[site]);
+      }
+      ++sites;
+    }
+  }
+  ASSERT_EQ(1000, sites);
+  ASSERT_FALSE(expected.update());
+  ASSERT_EQ(nullptr, pipelined.update());
+}
+
+TEST_F(PipelineGenotype, CanStopEarly) {
+  // the reader thread is blocked on a full queue when destroyed
+  std::istringstream input(contents);
+  std::istream sample_dummy(nullptr);
+  Genotype_Reader reader(&input);
+  reader.initialize(sample_dummy);
+  Pipelined_Genotype_Reader pipelined(&reader, 8);
+  const Genotype_Block *block = pipelined.update();
+  ASSERT_NE(nullptr, block);
+  ASSERT_EQ(8, block->sites);
+  ASSERT_EQ(1, block->positions[0]);
+}
+
+TEST(PipelineGenotypeError, CanRethrow) {
+  // binary header for samples n1 and m1 followed by an unknown record
+  std::string contents(BINARY_MAGIC, BINARY_MAGIC_LENGTH);
+  contents += std::string("\x02\x00\x00\x00\x02\x00\x00\x00n1", 10);
+  contents += std::string("\x02\x00\x00\x00m1", 6);
+  contents += "X";
+  std::istringstream input(contents);
+  std::istream sample_dummy(nullptr);
+  Genotype_Reader reader(&input);
+  ASSERT_EQ(1, reader.initialize(sample_dummy));
+  Pipelined_Genotype_Reader pipelined(&reader);
+  ASSERT_THROW(pipelined.update(), std::invalid_argument);
+  ASSERT_EQ(nullptr, pipelined.update());
+}
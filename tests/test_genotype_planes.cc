@@ -0,0 +1,107 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "IBDmix/genotype_planes.h"
+
+using ::testing::ElementsAre;
+
+TEST(GenotypePlanes, CanSetAndCount) {
+  std::string line = "\t\t0\t1\t2\t9\t2\t";
+  std::vector<int> indices = {4, 3, 0, 1, 2};
+  Genotype_Planes planes;
+  planes.resize(5);
+  ASSERT_EQ(5, planes.size());
+  planes.set(line.c_str() + 2, indices.data());
+
+  Allele_Counts counts = planes.count();
+  ASSERT_EQ(4, counts.called);
+  ASSERT_EQ(5, counts.alt);
+  std::vector<int> codes;
+  for (int i = 0; i < 5; ++i) codes.push_back(planes.code(i));
+  ASSERT_THAT(codes, ElementsAre(2, 3, 0, 1, 2));
+
+  Genotype_Table table = {{-1.5, 0.25, 2, 0}, {1, 0, 4, 0}};
+  std::vector<lod_t> lods(5);
+  std::vector<unsigned char> recover(5);
+  planes.fill_lods(table, lods.data(), recover.data());
+  ASSERT_THAT(lods, ElementsAre(2, 0, -1.5, 0.25, 2));
+  ASSERT_THAT(recover, ElementsAre(4, 0, 1, 0, 4));
+}
+
+TEST(GenotypePlanes, MatchesGenotypes) {
+  std::mt19937 gen(5);
+  std::uniform_int_distribution<int> genotype(0, 4);
+  Genotype_Table table = {{-3.25, 1e-7, 12.5, 0}, {8, 0, 16, 0}};
+  Genotype_Planes planes;
+  for (int count : {1, 63, 64, 65, 200, 2504}) {
+    // every other column, with unexpected characters as missing
+    std::string line = "\t\t";
+    std::vector<int> indices;
+    for (int i = 0; i < 2 * count; ++i) {
+      line += "0129x"[genotype(gen)];
+      line += '\t';
+      if (i % 2 == 1) indices.push_back(i);
+    }
+    const char *genotypes = line.c_str() + 2;
+    planes.resize(count);
+    planes.set(genotypes, indices.data());
+
+    Allele_Counts counts = planes.count();
+    Allele_Counts expected = {0, 0};
+    for (int i : indices) {
+      char value = genotypes[2 * i];
+      if (value == '0' || value == '1' || value == '2') {
+        ++expected.called;
+        expected.alt += value - '0';
+      }
+    }
+    ASSERT_EQ(expected.called, counts.called);
+    ASSERT_EQ(expected.alt, counts.alt);
+
+    std::vector<lod_t> expected_lods(count), lods(count);
+    std::vector<unsigned char> expected_recover(count), recover(count);
+    for (int i = 0; i < count; ++i) {
+      char value = genotypes[2 * indices[i]];
+      int code = value >= '0' && value <= '2' ? value - '0' : 3;
+      expected_lods[i] = table.lods[code];
+      expected_recover[i] = table.recover[code];
+    }
+    planes.fill_lods(table, lods.data(), recover.data());
+    ASSERT_EQ(expected_lods, lods);
+    ASSERT_EQ(expected_recover, recover);
+  }
+}
+
+TEST(GenotypePlanes, CanSkipColumn) {
+  std::mt19937 gen(7);
+  std::uniform_int_distribution<int> genotype(0, 4);
+  Genotype_Planes planes, expected;
+  for (int count : {1, 63, 64, 65, 127, 128, 200}) {
+    std::string line = "\t\t";
+    for (int i = 0; i <= count; ++i) {
+      line += "0129x"[genotype(gen)];
+      line += '\t';
+    }
+    const char *genotypes = line.c_str() + 2;
+    planes.resize(count);
+    expected.resize(count);
+    for (int skip : {0, 1, count / 2, count - 1, count}) {
+      std::vector<int> indices;
+      for (int i = 0; i <= count; ++i)
+        if (i != skip) indices.push_back(i);
+      expected.set(genotypes, indices.data());
+      planes.set_all_except(genotypes, skip);
+
+      Allele_Counts expected_counts = expected.count(),
+                    counts = planes.count();
+      ASSERT_EQ(expected_counts.called, counts.called);
+      ASSERT_EQ(expected_counts.alt, counts.alt);
+      for (int i = 0; i < count; ++i)
+        ASSERT_EQ(expected.code(i), planes.code(i));
+    }
+  }
+}
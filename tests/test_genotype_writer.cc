@@ -0,0 +1,104 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "IBDmix/Genotype_Reader.h"
+#include "IBDmix/genotype_format.h"
+#include "IBDmix/genotype_writer.h"
+
+class GenotypeSites : public ::testing::Test {
+ protected:
+  void write(Genotype_Writer *writer) {
+    writer->writeHeader();
+    writer->writeSite("1", 2, 'A', 'T', "1\t", "0\t0\t1\t9\t1\t");
+    writer->writeSite("1", 4, 'A', 'T', "2\t", "0\t1\t1\t1\t2\t");
+    writer->writeSite("1", 105, 'C', 'G', "0\t", "2\t1\t2\t1\t1\t");
+    writer->writeSite("2", 125, 'G', 'C', "0\t", "2\t2\t1\t9\t0\t");
+    writer->writeSite("3", 126, 'T', 'A', "0\t", "9\t9\t9\t9\t9\t");
+  }
+
+  std::vector<std::string> samples = {"n1", "m1", "m2", "m3", "m4", "m5"};
+  std::ostringstream output;
+};
+
+TEST_F(GenotypeSites, CanWriteText) {
+  Text_Genotype_Writer writer(output, samples);
+  write(&writer);
+  writer.flush();
+  ASSERT_EQ(
+      "chrom\tpos\tref\talt\tn1\tm1\tm2\tm3\tm4\tm5\n"
+      "1\t2\tA\tT\t1\t0\t0\t1\t9\t1\t\n"
+      "1\t4\tA\tT\t2\t0\t1\t1\t1\t2\t\n"
+      "1\t105\tC\tG\t0\t2\t1\t2\t1\t1\t\n"
+      "2\t125\tG\tC\t0\t2\t2\t1\t9\t0\t\n"
+      "3\t126\tT\tA\t0\t9\t9\t9\t9\t9\t\n",
+      output.str());
+}
+
+TEST_F(GenotypeSites, CanWriteBinary) {
+  Binary_Genotype_Writer writer(output, {"n1", "m1"});
+  writer.writeHeader();
+  writer.writeSite("1", 258, 'A', 'T', "1\t", "9\t");
+  writer.writeSite("1", 259, 'A', 'T', "2\t", "0\t");
+  writer.flush();
+
+  std::string expected(BINARY_MAGIC, BINARY_MAGIC_LENGTH);
+  expected += std::string("\x02\0\0\0", 4);
+  expected += std::string("\x02\0\0\0n1", 6);
+  expected += std::string("\x02\0\0\0m1", 6);
+  expected += std::string("C\x01\0\0\0" "1", 6);
+  expected += std::string("S\x02\x01\0\0\0\0\0\0AT\x0d", 12);
+  expected += std::string("S\x03\x01\0\0\0\0\0\0AT\x02", 12);
+  ASSERT_EQ(expected, output.str());
+}
+
+TEST_F(GenotypeSites, CanReadBinary) {
+  std::ostringstream text_output;
+  Text_Genotype_Writer text_writer(text_output, samples);
+  write(&text_writer);
+  text_writer.flush();
+  Binary_Genotype_Writer binary_writer(output, samples);
+  write(&binary_writer);
+  binary_writer.flush();
+  ASSERT_LT(output.str().size(), text_output.str().size());
+
+  std::istringstream text_input(text_output.str());
+  std::istringstream binary_input(output.str());
+  Genotype_Reader text(&text_input);
+  Genotype_Reader binary(&binary_input);
+  std::istringstream text_samples("m1\nm3\nm5"), binary_samples("m1\nm3\nm5");
+  ASSERT_EQ(3, text.initialize(text_samples));
+  ASSERT_EQ(3, binary.initialize(binary_samples));
+  ASSERT_EQ(text.get_samples(), binary.get_samples());
+
+  while (text.update()) {
+    ASSERT_TRUE(binary.update());
+    ASSERT_EQ(text.getChromosome(), binary.getChromosome());
+    ASSERT_EQ(text.getPosition(), binary.getPosition());
+    ASSERT_EQ(text.getRef(), binary.getRef());
+    ASSERT_EQ(text.getAlt(), binary.getAlt());
+    ASSERT_EQ(text.getArchaic(), binary.getArchaic());
+    ASSERT_EQ(text.getLineFilter(), binary.getLineFilter());
+    ASSERT_EQ(text.getAlleleFrequency(), binary.getAlleleFrequency());
+    for (int i = 0; i < text.num_samples(); ++i) {
+      ASSERT_EQ(text.getLodScore(i), binary.getLodScore(i));
+      ASSERT_EQ(text.getRecoverType(i), binary.getRecoverType(i));
+    }
+  }
+  ASSERT_FALSE(binary.update());
+}
+
+TEST_F(GenotypeSites, ThrowsOnTruncatedBinary) {
+  Binary_Genotype_Writer writer(output, samples);
+  write(&writer);
+  writer.flush();
+  std::string truncated = output.str();
+  truncated.resize(truncated.size() - 1);
+  std::istringstream input(truncated);
+  Genotype_Reader reader(&input);
+  std::istream sample_dummy(nullptr);
+  reader.initialize(sample_dummy);
+  for (int i = 0; i < 4; ++i) ASSERT_TRUE(reader.update());
+  ASSERT_THROW(reader.update(), std::invalid_argument);
+}
@@ -84,3 +84,23 @@ TEST(LodCalculator, CanGetModernError) {
   ASSERT_DOUBLE_EQ(0.02, calc.get_modern_error(0.01));
   ASSERT_TRUE(abs((calc.get_modern_error(0.99) - 0.02) / 0.02) < 0.001);
 }
+
+TEST(LodCalculator, TableMatchesFrequency) {
+  LodCalculator table(0.01, 0.002, 2, 1e-200);
+  LodCalculator direct(0.01, 0.002, 2, 1e-200);
+  table.initialize_table(20);
+  char gts[] = {'0', '1', '2', '9'};
+  // twice to check both new and stored entries, beyond the table size
+  for (int pass = 0; pass < 2; ++pass)
+    for (int called = 0; called <= 25; ++called)
+      for (int alt = 0; alt <= 2 * called; ++alt)
+        for (char arch : gts)
+          for (bool selected : {true, false}) {
+            table.update_lod_cache(arch, alt, called, selected);
+            direct.update_lod_cache(
+                arch, called == 0 ? 0 : static_cast<double>(alt) / (2 * called),
+                selected);
+            for (char mod : gts)
+              ASSERT_EQ(direct.calculate_lod(mod), table.calculate_lod(mod));
+          }
+}
@@ -0,0 +1,58 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include "IBDmix/output_buffer.h"
+
+TEST(OutputBuffer, CanWriteIntegers) {
+  std::ostringstream output;
+  Output_Buffer buffer(output);
+  buffer << 0 << ' ' << 7 << ' ' << 10 << ' ' << 99 << ' ' << 100 << ' '
+         << 12345 << ' ' << -1 << ' ' << -120 << ' '
+         << std::numeric_limits<uint64_t>::max() << ' '
+         << std::numeric_limits<int64_t>::min();
+  ASSERT_EQ("", output.str());
+  buffer.flush();
+  ASSERT_EQ(
+      "0 7 10 99 100 12345 -1 -120 18446744073709551615 "
+      "-9223372036854775808",
+      output.str());
+}
+
+TEST(OutputBuffer, MatchesOstream) {
+  std::ostringstream expected, output;
+  {
+    Output_Buffer buffer(output);
+    for (double value : {0.0, 1.0, -1.5, 0.125, 1.0 / 3, -1.99568e-5,
+                         123456789.0, 1e-200, -HUGE_VAL, HUGE_VAL}) {
+      expected << value << '\t';
+      buffer << value << '\t';
+    }
+    for (uint64_t value = 1; value < 1e18; value = value * 7 + 3) {
+      expected << value << "\n";
+      buffer << value << "\n";
+    }
+    std::string text = "chrom";
+    expected << text << 'A' << true;
+    buffer << text << 'A' << true;
+  }
+  // flushed when destroyed
+  ASSERT_EQ(expected.str(), output.str());
+}
+
+TEST(OutputBuffer, CanFillBuffer) {
+  std::ostringstream expected, output;
+  Output_Buffer buffer(output, 40);
+  std::string large(100, 'x');
+  for (int i = 0; i < 1000; ++i) {
+    expected << i << '\t' << (i % 50 == 0 ? large : "ab") << 0.5 << '\n';
+    buffer << i << '\t' << (i % 50 == 0 ? large : "ab") << 0.5 << '\n';
+  }
+  buffer.flush();
+  ASSERT_EQ(expected.str(), output.str());
+}
@@ -0,0 +1,269 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "IBDmix/simd_kernels.h"
+
+class GenotypeLine : public ::testing::Test {
+ protected:
+  // build a FORMAT=GT sample section with count samples
+  void build(int count, unsigned int seed, double missing = 0.1) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    line.clear();
+    for (int i = 0; i < count; ++i) {
+      char first = uniform(gen) < missing ? '.' : '0' + (uniform(gen) < 0.3);
+      char second = first == '.' ? '.' : '0' + (uniform(gen) < 0.3);
+      line += first;
+      line += uniform(gen) < 0.5 ? '|' : '/';
+      line += second;
+      if (i != count - 1) line += '\t';
+    }
+  }
+
+  std::string decode(bool (*kernel)(const char *, char *, int), int count,
+                     bool *none_valid) {
+    std::string result(2 * count, 'x');
+    *none_valid = kernel(line.c_str(), &result[0], count);
+    return result;
+  }
+
+  void check_all(int count) {
+    bool expected_none, none;
+    std::string expected = decode(decode_gt_scalar, count, &expected_none);
+    ASSERT_EQ(decode(decode_gt, count, &none), expected);
+    ASSERT_EQ(none, expected_none);
+    if (cpu_has_sse42()) {
+      ASSERT_EQ(decode(decode_gt_sse42, count, &none), expected);
+      ASSERT_EQ(none, expected_none);
+    }
+    if (cpu_has_avx2()) {
+      ASSERT_EQ(decode(decode_gt_avx2, count, &none), expected);
+      ASSERT_EQ(none, expected_none);
+    }
+  }
+
+  std::string line;
+};
+
+TEST_F(GenotypeLine, CanDecodeScalar) {
+  line = "0|0\t1|0\t0/1\t1|1\t.|.";
+  bool none_valid;
+  ASSERT_EQ(decode(decode_gt_scalar, 5, &none_valid), "0\t1\t1\t2\t9\t");
+  ASSERT_FALSE(none_valid);
+
+  line = ".|.\t./.";
+  ASSERT_EQ(decode(decode_gt_scalar, 2, &none_valid), "9\t9\t");
+  ASSERT_TRUE(none_valid);
+}
+
+TEST_F(GenotypeLine, KernelsMatchScalar) {
+  for (int count = 1; count < 70; ++count) {
+    build(count, count);
+    check_all(count);
+  }
+  build(2504, 2504);
+  check_all(2504);
+}
+
+TEST_F(GenotypeLine, KernelsFindAllMissing) {
+  for (int count : {1, 8, 15, 16, 17, 33, 100}) {
+    build(count, count, 1.0);
+    check_all(count);
+    bool none_valid;
+    decode(decode_gt, count, &none_valid);
+    ASSERT_TRUE(none_valid);
+
+    // a single call in any position is valid
+    for (int i = 0; i < count; ++i) {
+      build(count, count, 1.0);
+      line[4 * i] = '0';
+      line[4 * i + 2] = '0';
+      check_all(count);
+      decode(decode_gt, count, &none_valid);
+      ASSERT_FALSE(none_valid);
+    }
+  }
+}
+
+class GenotypeSlices : public ::testing::Test {
+ protected:
+  // build a genotype file sample section with count samples, after 2 bytes
+  // of padding needed by the gather kernels
+  void build(int count, unsigned int seed) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> genotype(0, 3);
+    line = "\t\t";
+    for (int i = 0; i < count; ++i) {
+      int value = genotype(gen);
+      line += value == 3 ? '9' : '0' + value;
+      line += '\t';
+    }
+    indices.clear();
+    for (int i = count - 1; i >= 0; i -= 1 + genotype(gen))
+      indices.push_back(i);
+  }
+
+  const char *genotypes() { return line.c_str() + 2; }
+
+  // table entries of the samples at indices, looked up one at a time
+  void lookup(const Genotype_Table &table, std::vector<lod_t> *lods,
+              std::vector<unsigned char> *recover) {
+    for (size_t i = 0; i < indices.size(); ++i) {
+      char genotype = genotypes()[2 * indices[i]];
+      int code = genotype >= '0' && genotype <= '2' ? genotype - '0' : 3;
+      (*lods)[i] = table.lods[code];
+      (*recover)[i] = table.recover[code];
+    }
+  }
+
+  std::string line;
+  std::vector<int> indices;
+};
+
+TEST_F(GenotypeSlices, CanSliceScalar) {
+  line = "\t\t0\t1\t2\t9\t2\t";
+  indices = {4, 3, 0, 1, 2};
+  uint64_t first, second, missing;
+  slice_genotypes_scalar(genotypes(), indices.data(), 5, &first, &second,
+                         &missing);
+  ASSERT_EQ(0x19u, first);
+  ASSERT_EQ(0x11u, second);
+  ASSERT_EQ(0x2u, missing);
+}
+
+TEST_F(GenotypeSlices, SliceMatchesScalar) {
+  for (int count : {0, 1, 7, 8, 63, 64, 65, 100, 128, 2504}) {
+    for (unsigned int seed = 0; seed < 5; ++seed) {
+      build(count, seed);
+      line[2] = 'x';  // anything unexpected is missing
+      int samples = indices.size();
+      int words = (samples + 63) / 64;
+      std::vector<uint64_t> expected(3 * words), result(3 * words);
+      slice_genotypes_scalar(genotypes(), indices.data(), samples,
+                             &expected[0], &expected[words],
+                             &expected[2 * words]);
+      slice_genotypes(genotypes(), indices.data(), samples, &result[0],
+                      &result[words], &result[2 * words]);
+      ASSERT_EQ(expected, result);
+      if (cpu_has_avx2()) {
+        slice_genotypes_avx2(genotypes(), indices.data(), samples, &result[0],
+                             &result[words], &result[2 * words]);
+        ASSERT_EQ(expected, result);
+      }
+
+      // all columns in order
+      int columns = (count + 63) / 64;
+      std::vector<int> all(count);
+      for (int i = 0; i < count; ++i) all[i] = i;
+      std::vector<uint64_t> expected_all(3 * columns), all_result(3 * columns);
+      slice_genotypes_scalar(genotypes(), all.data(), count, &expected_all[0],
+                             &expected_all[columns],
+                             &expected_all[2 * columns]);
+      slice_genotypes_contiguous_scalar(genotypes(), count, &all_result[0],
+                                        &all_result[columns],
+                                        &all_result[2 * columns]);
+      ASSERT_EQ(expected_all, all_result);
+      slice_genotypes_contiguous(genotypes(), count, &all_result[0],
+                                 &all_result[columns],
+                                 &all_result[2 * columns]);
+      ASSERT_EQ(expected_all, all_result);
+      if (cpu_has_avx2()) {
+        slice_genotypes_contiguous_avx2(genotypes(), count, &all_result[0],
+                                        &all_result[columns],
+                                        &all_result[2 * columns]);
+        ASSERT_EQ(expected_all, all_result);
+      }
+
+      // filling from the planes matches looking up the genotypes
+      Genotype_Table table = {{-3.25, 1e-7, 12.5, 0}, {8, 0, 16, 0}};
+      std::vector<lod_t> expected_lods(samples), lods(samples);
+      std::vector<unsigned char> expected_recover(samples), recover(samples);
+      lookup(table, &expected_lods, &expected_recover);
+      fill_lods_planes_scalar(&result[0], &result[words], &result[2 * words],
+                              samples, table, lods.data(), recover.data());
+      ASSERT_EQ(expected_lods, lods);
+      ASSERT_EQ(expected_recover, recover);
+      fill_lods_planes(&result[0], &result[words], &result[2 * words],
+                       samples, table, lods.data(), recover.data());
+      ASSERT_EQ(expected_lods, lods);
+      ASSERT_EQ(expected_recover, recover);
+      if (cpu_has_avx2()) {
+        fill_lods_planes_avx2(&result[0], &result[words], &result[2 * words],
+                              samples, table, lods.data(), recover.data());
+        ASSERT_EQ(expected_lods, lods);
+        ASSERT_EQ(expected_recover, recover);
+      }
+    }
+  }
+}
+
+// lods with 0, -0 and NaN, which are not below 0, among random values
+static std::vector<lod_t> random_lods(int count, unsigned int seed) {
+  std::mt19937 gen(seed);
+  std::uniform_int_distribution<int> kind(0, 9);
+  std::uniform_real_distribution<double> value(-2, 1);
+  std::vector<lod_t> lods(count);
+  for (auto &lod : lods) {
+    switch (kind(gen)) {
+      case 0:
+        lod = 0;
+        break;
+      case 1:
+        lod = -0.0;
+        break;
+      case 2:
+        lod = std::numeric_limits<lod_t>::quiet_NaN();
+        break;
+      case 3:
+        lod = -std::numeric_limits<lod_t>::infinity();
+        break;
+      default:
+        lod = value(gen);
+    }
+  }
+  return lods;
+}
+
+TEST(NonnegativeLods, CanFindScalar) {
+  std::vector<lod_t> lods = {-1, -0.5, 0, 2, -3};
+  std::vector<uint64_t> bits(1);
+  nonnegative_lods_scalar(lods.data(), lods.size(), bits.data());
+  ASSERT_EQ(0xcu, bits[0]);
+  ASSERT_EQ(2, find_nonnegative_lod_scalar(lods.data(), lods.size()));
+  ASSERT_EQ(2, find_nonnegative_lod_scalar(lods.data(), 2));
+}
+
+TEST(NonnegativeLods, MatchesScalar) {
+  for (int count : {0, 1, 3, 4, 8, 63, 64, 65, 100, 2504}) {
+    for (unsigned int seed = 0; seed < 5; ++seed) {
+      std::vector<lod_t> lods = random_lods(count, seed);
+      int words = (count + 63) / 64;
+      std::vector<uint64_t> expected(words), bits(words, ~uint64_t(0));
+      nonnegative_lods_scalar(lods.data(), count, expected.data());
+      nonnegative_lods(lods.data(), count, bits.data());
+      ASSERT_EQ(expected, bits);
+      if (cpu_has_avx2()) {
+        nonnegative_lods_avx2(lods.data(), count, bits.data());
+        ASSERT_EQ(expected, bits);
+      }
+
+      // from every start, so the first match is at each offset
+      for (int start = 0; start <= count; ++start) {
+        int expected_index =
+            find_nonnegative_lod_scalar(lods.data() + start, count - start);
+        ASSERT_EQ(expected_index,
+                  find_nonnegative_lod(lods.data() + start, count - start));
+        if (cpu_has_avx2()) {
+          ASSERT_EQ(expected_index, find_nonnegative_lod_avx2(
+                                        lods.data() + start, count - start));
+        }
+      }
+    }
+  }
+}
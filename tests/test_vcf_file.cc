@@ -1,6 +1,8 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <zlib.h>
 
+#include <cstdio>
 #include <iostream>
 #include <sstream>
 
@@ -173,3 +175,138 @@ TEST(VcfFile, CanParseComplexFormat) {
   // no GT in format
   ASSERT_THROW(vcf.update(), std::invalid_argument);
 }
+
+TEST(VcfFile, CanSkipNonInformative) {
+  std::istringstream vcf_file(
+      "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\tA1\tA2\n"
+      "1\t1\t.\tT\t.\t.\t.\t.\tGT:DP\t./.:1\t.|.:2\n"
+      "1\t2\t.\tT\t.\t.\t.\t.\tGT:DP\t0/0:1\t0/0:2\n"
+      "1\t3\t.\tT\t.\t.\t.\t.\tGT\t./.\t./.\n"
+      "1\t4\t.\tT\t.\t.\t.\t.\tDP:GT\t1:./.\t2:./.\n"
+      "1\t5\t.\tT\t.\t.\t.\t.\tGT\t./.\t0/1\n"
+      "1\t6\t.\tT\t.\t.\t.\t.\tGT\t0/0\t./.\n");
+  std::ostringstream output;
+  VCF_File vcf(&vcf_file, output);
+
+  // hom ref lines are kept but not informative
+  ASSERT_TRUE(vcf.update(true));
+  ASSERT_EQ(vcf.getPosition(), 2);
+  ASSERT_FALSE(vcf.isInformative());
+
+  // missing detected after decoding when GT is not first
+  ASSERT_TRUE(vcf.update(true));
+  ASSERT_EQ(vcf.getPosition(), 5);
+  ASSERT_TRUE(vcf.isInformative());
+  ASSERT_EQ(vcf.getGenotypes(), "9\t1\t");
+
+  // partially missing lines are kept
+  ASSERT_TRUE(vcf.update(true));
+  ASSERT_EQ(vcf.getPosition(), 6);
+  ASSERT_TRUE(vcf.isInformative());
+
+  ASSERT_FALSE(vcf.update(true));
+}
+
+TEST(VcfFile, CanSelectSamples) {
+  std::string contents(
+      "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\t"
+      "I1\tI2\tI3\tI4\tI5\n"
+      "1\t846688\t.\tG\tA\t.\tPASS\t.\tGT\t"
+      "1|0\t1|1\t0|1\t0|0\t.|.\n"
+      "1\t846689\t.\tG\tA\t.\tPASS\t.\tGT:DP\t"
+      "0|0:1\t1|1:12\t0|0:3\t1|0:4\t.|.:5\n"
+      "1\t846690\t.\tG\tA\t.\tPASS\t.\tGT\t"
+      "0|0\t0|0\t0|0\t1|0\t0|0\n");
+
+  // output is in file order, missing names are ignored
+  std::istringstream vcf_file(contents);
+  std::ostringstream output;
+  VCF_File vcf(&vcf_file, output, {"I5", "I2", "I3", "missing"});
+  ASSERT_EQ(output.str(), "\tI2\tI3\tI5");
+  ASSERT_EQ(vcf.getCount(), 3);
+  ASSERT_EQ(vcf.getBlank(), "0\t0\t0\t");
+
+  ASSERT_TRUE(vcf.update());
+  ASSERT_EQ(vcf.getPosition(), 846688);
+  ASSERT_EQ(vcf.getGenotypes(), "2\t1\t9\t");
+
+  ASSERT_TRUE(vcf.update());
+  ASSERT_EQ(vcf.getPosition(), 846689);
+  ASSERT_EQ(vcf.getGenotypes(), "2\t0\t9\t");
+
+  // only unselected samples are non-reference
+  ASSERT_TRUE(vcf.update());
+  ASSERT_EQ(vcf.getPosition(), 846690);
+  ASSERT_EQ(vcf.getGenotypes(), "0\t0\t0\t");
+
+  ASSERT_FALSE(vcf.update());
+
+  // no selected samples in the file
+  std::istringstream vcf_file2(contents);
+  std::ostringstream output2;
+  VCF_File vcf2(&vcf_file2, output2, {"missing"});
+  ASSERT_EQ(output2.str(), "");
+  ASSERT_EQ(vcf2.getCount(), 0);
+  ASSERT_TRUE(vcf2.update());
+  ASSERT_EQ(vcf2.getPosition(), 846688);
+  ASSERT_EQ(vcf2.getGenotypes(), "");
+}
+
+TEST(VcfFile, CanSkipMalformedLines) {
+  std::istringstream vcf_file(
+      "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\tI1\tI2\n"
+      "\n"
+      "4\tpos\t.\tC\tG\t.\tPASS\t.\tGT\t1|0\t0|0\n"
+      "4\t10\t.\tC\tG\t.\tPASS\t.\tGT\n"
+      "4\t11\t.\tC\n"
+      "4\t12\t.\tC\tG\t.\tPASS\tDP=3\tGTX:GT\t0|0:1|1\t1|1:.|.\n");
+  std::ostringstream output;
+  VCF_File vcf(&vcf_file, output);
+  ASSERT_EQ(vcf.getCount(), 2);
+
+  // missing alt is reported as invalid
+  ASSERT_TRUE(vcf.update());
+  ASSERT_EQ(vcf.getPosition(), 11);
+  ASSERT_FALSE(vcf.isValid());
+
+  // GT must match a full format field
+  ASSERT_TRUE(vcf.update());
+  ASSERT_EQ(vcf.getChromosome(), "4");
+  ASSERT_EQ(vcf.getPosition(), 12);
+  ASSERT_TRUE(vcf.isValid());
+  ASSERT_EQ(vcf.getGenotypes()[0], '2');
+  ASSERT_EQ(vcf.getGenotypes()[2], '9');
+
+  ASSERT_TRUE(!vcf.update());
+}
+
+TEST(VcfFile, CanReadCompressedFile) {
+  std::string filename = testing::TempDir() + "vcf_file_test.vcf.gz";
+  std::string contents(
+      "##fileformat=VCFv4.2\n"
+      "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\tI1\tI2\n"
+      "2\t100\t.\tC\tT\t.\tPASS\t.\tGT\t0|1\t1|1\n"
+      "2\t101\t.\tG\tA\t.\tPASS\t.\tGT\t.|.\t0|0\n");
+  gzFile file = gzopen(filename.c_str(), "wb");
+  gzwrite(file, contents.data(), contents.size());
+  gzclose(file);
+
+  std::ostringstream output;
+  VCF_File vcf(filename, output);
+  ASSERT_STREQ(output.str().c_str(), "\tI1\tI2");
+  ASSERT_EQ(vcf.getCount(), 2);
+
+  ASSERT_TRUE(vcf.update());
+  ASSERT_EQ(vcf.getChromosome(), "2");
+  ASSERT_EQ(vcf.getPosition(), 100);
+  ASSERT_EQ(vcf.getGenotypes()[0], '1');
+  ASSERT_EQ(vcf.getGenotypes()[2], '2');
+
+  ASSERT_TRUE(vcf.update());
+  ASSERT_EQ(vcf.getPosition(), 101);
+  ASSERT_EQ(vcf.getGenotypes()[0], '9');
+  ASSERT_EQ(vcf.getGenotypes()[2], '0');
+
+  ASSERT_TRUE(!vcf.update());
+  std::remove(filename.c_str());
+}
@@ -0,0 +1,130 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "IBDmix/vcf_index.h"
+
+using ::testing::ElementsAre;
+
+class IndexFile : public ::testing::Test {
+ protected:
+  void SetUp() {
+    filename = testing::TempDir() + "vcf_index_test.vcf.gz";
+    // chromosome 3 is listed but has no records
+    names = std::string("1\0002\0003\0", 6);
+  }
+
+  void TearDown() {
+    std::remove((filename + ".tbi").c_str());
+    std::remove((filename + ".csi").c_str());
+  }
+
+  void write(const std::string &extension, const std::string &contents) {
+    gzFile file = gzopen((filename + extension).c_str(), "wb");
+    gzwrite(file, contents.data(), contents.size());
+    gzclose(file);
+  }
+
+  void add_int(std::string *data, uint32_t value) {
+    for (int i = 0; i < 4; ++i) data->push_back((value >> (8 * i)) & 0xff);
+  }
+
+  void add_long(std::string *data, uint64_t value) {
+    for (int i = 0; i < 8; ++i) data->push_back((value >> (8 * i)) & 0xff);
+  }
+
+  std::string tabix_header() {
+    std::string result;
+    // format, col_seq, col_beg, col_end, meta ('#'), skip, l_nm
+    for (uint32_t value : {2, 1, 2, 0, 35, 0}) add_int(&result, value);
+    add_int(&result, names.size());
+    return result + names;
+  }
+
+  // bins for a reference with records starting at the provided offsets
+  void add_bins(std::string *data, std::vector<uint64_t> starts,
+                uint32_t pseudo_bin, bool csi) {
+    add_int(data, starts.size() + 1);
+    for (size_t i = 0; i < starts.size(); ++i) {
+      add_int(data, 4681 + i);
+      if (csi) add_long(data, starts[i]);
+      add_int(data, 1);
+      add_long(data, starts[i]);
+      add_long(data, starts[i] + 100);
+    }
+    // pseudo bin with a misleading first chunk
+    add_int(data, pseudo_bin);
+    if (csi) add_long(data, 0);
+    add_int(data, 2);
+    add_long(data, 0);
+    add_long(data, 1);
+    add_long(data, 10);
+    add_long(data, 0);
+  }
+
+  std::string filename;
+  std::string names;
+};
+
+TEST_F(IndexFile, CanFindIndex) {
+  ASSERT_EQ(VCF_Index::find(filename), "");
+  write(".csi", "");
+  ASSERT_EQ(VCF_Index::find(filename), filename + ".csi");
+  write(".tbi", "");
+  ASSERT_EQ(VCF_Index::find(filename), filename + ".tbi");
+}
+
+TEST_F(IndexFile, CanReadTabix) {
+  std::string data("TBI\1", 4);
+  add_int(&data, 3);
+  data += tabix_header();
+  add_bins(&data, {(5 << 16) | 20, (2 << 16) | 10}, 37450, false);
+  add_int(&data, 1);  // linear index
+  add_long(&data, 0);
+  add_bins(&data, {(9 << 16) | 3}, 37450, false);
+  add_int(&data, 0);
+  add_int(&data, 0);  // no bins for 3
+  add_int(&data, 0);
+  write(".tbi", data);
+
+  VCF_Index index(filename + ".tbi");
+  ASSERT_THAT(index.getChromosomes(), ElementsAre("1", "2"));
+  ASSERT_TRUE(index.contains("1"));
+  ASSERT_FALSE(index.contains("3"));
+  ASSERT_EQ(index.getOffset("1"), (2 << 16) | 10);
+  ASSERT_EQ(index.getOffset("2"), (9 << 16) | 3);
+  ASSERT_THROW(index.getOffset("3"), std::invalid_argument);
+}
+
+TEST_F(IndexFile, CanReadCSI) {
+  std::string data("CSI\1", 4);
+  add_int(&data, 14);  // min_shift
+  add_int(&data, 6);   // depth
+  std::string aux = tabix_header();
+  add_int(&data, aux.size());
+  data += aux;
+  add_int(&data, 3);
+  uint32_t pseudo_bin = ((1 << 21) - 1) / 7 + 1;
+  // chromosome 2 before 1 in file
+  add_bins(&data, {(12 << 16) | 20}, pseudo_bin, true);
+  add_bins(&data, {(9 << 16) | 3, (9 << 16) | 1}, pseudo_bin, true);
+  add_int(&data, 0);
+  write(".csi", data);
+
+  VCF_Index index(filename + ".csi");
+  ASSERT_THAT(index.getChromosomes(), ElementsAre("2", "1"));
+  ASSERT_EQ(index.getOffset("1"), (12 << 16) | 20);
+  ASSERT_EQ(index.getOffset("2"), (9 << 16) | 1);
+}
+
+TEST_F(IndexFile, ThrowsOnBadIndex) {
+  write(".tbi", "BAM\1");
+  ASSERT_THROW(VCF_Index(filename + ".tbi"), std::invalid_argument);
+
+  write(".tbi", std::string("TBI\1\3\0", 6));
+  ASSERT_THROW(VCF_Index(filename + ".tbi"), std::invalid_argument);
+}
@@ -0,0 +1,149 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "IBDmix/genotype_writer.h"
+#include "IBDmix/vcf_file.h"
+#include "IBDmix/vcf_merge.h"
+#include "IBDmix/vcf_pipeline.h"
+
+class MergeVcfs : public ::testing::Test {
+ protected:
+  // vcf with one sample named name, each line is CHROM POS REF ALT GT
+  static std::string vcf(const std::string &name,
+                         const std::vector<std::string> &lines) {
+    std::ostringstream strm;
+    strm << "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\t" << name
+         << '\n';
+    for (auto &line : lines) {
+      std::istringstream fields(line);
+      std::string chromosome, position, reference, alternative, genotype;
+      fields >> chromosome >> position >> reference >> alternative >>
+          genotype;
+      strm << chromosome << '\t' << position << "\t.\t" << reference << '\t'
+           << alternative << "\t.\tPASS\t.\tGT\t" << genotype << '\n';
+    }
+    return strm.str();
+  }
+
+  // merge archaic with the moderns, for both file types
+  std::string merge(const std::string &archaic,
+                    const std::vector<std::string> &moderns) {
+    std::string result = merge_files(archaic, moderns, false);
+    EXPECT_EQ(result, merge_files(archaic, moderns, true));
+    return result;
+  }
+
+  std::string merge_files(const std::string &archaic,
+                          const std::vector<std::string> &moderns,
+                          bool pipelined) {
+    std::ostringstream names, output;
+    std::istringstream archaic_input(archaic);
+    VCF_File archaic_file(&archaic_input, names);
+    std::vector<std::unique_ptr<std::istringstream>> inputs;
+    std::vector<std::unique_ptr<VCF_File>> modern_files;
+    std::vector<std::string> samples = archaic_file.getSamples();
+    for (auto &modern : moderns) {
+      inputs.emplace_back(new std::istringstream(modern));
+      modern_files.emplace_back(new VCF_File(inputs.back().get(), names));
+      samples.push_back(modern_files.back()->getSamples()[0]);
+    }
+    std::vector<bool> has_records(moderns.size(), true);
+
+    Text_Genotype_Writer writer(output, samples);
+    writer.writeHeader();
+    if (pipelined) {
+      Pipelined_VCF_File pipelined_archaic(&archaic_file, true);
+      std::vector<std::unique_ptr<Pipelined_VCF_File>> pipelined_files;
+      std::vector<Pipelined_VCF_File *> pointers;
+      for (auto &file : modern_files) {
+        pipelined_files.emplace_back(new Pipelined_VCF_File(file.get()));
+        pointers.push_back(pipelined_files.back().get());
+      }
+      merge_vcfs(&pipelined_archaic, pointers, has_records, &writer);
+    } else {
+      std::vector<VCF_File *> pointers;
+      for (auto &file : modern_files) pointers.push_back(file.get());
+      merge_vcfs(&archaic_file, pointers, has_records, &writer);
+    }
+    writer.flush();
+    return output.str();
+  }
+
+  // blank cohorts are homozygous reference
+  std::string header = "chrom\tpos\tref\talt\tn1\tm1\tm2\n";
+};
+
+TEST_F(MergeVcfs, CanMergeMissingSites) {
+  std::string archaic =
+      vcf("n1", {"1 100 A T 1|1", "1 150 G C 0|1", "1 200 A T 0|1"});
+  std::string modern1 = vcf("m1", {"1 100 A T 0|1", "1 200 A T 1|1"});
+  std::string modern2 = vcf("m2", {"1 200 A T 1|0", "1 300 A T 1|1"});
+
+  ASSERT_EQ(header +
+                "1\t100\tA\tT\t2\t1\t0\t\n"
+                "1\t150\tG\tC\t1\t0\t0\t\n"
+                "1\t200\tA\tT\t1\t2\t1\t\n",
+            merge(archaic, {modern1, modern2}));
+}
+
+TEST_F(MergeVcfs, CanMergeMismatchedAlleles) {
+  // the archaic alternative is set by the first matching cohort
+  std::string archaic = vcf("n1", {"1 100 A T 1|1", "1 200 C G 0|1",
+                                   "1 300 A . 1|1", "1 400 A T 1|1"});
+  std::string modern1 = vcf("m1", {"1 100 A T 0|1", "1 200 A G 1|1",
+                                   "1 300 A C 0|1", "1 400 A G 0|1"});
+  std::string modern2 = vcf("m2", {"1 100 A G 1|1", "1 200 C G 0|1",
+                                   "1 300 A G 0|0", "1 400 G T 1|1"});
+
+  ASSERT_EQ(header +
+                "1\t100\tA\tT\t2\t1\t0\t\n"
+                "1\t200\tC\tG\t1\t0\t1\t\n"
+                "1\t300\tA\tC\t2\t1\t0\t\n",
+            merge(archaic, {modern1, modern2}));
+}
+
+TEST_F(MergeVcfs, CanMergeDifferentChromosomes) {
+  // equal positions are only matched on the archaic chromosome
+  std::string archaic = vcf("n1", {"1 100 A T 1|1", "1 200 A T 1|1"});
+  std::string modern1 = vcf("m1", {"1 100 A T 0|1", "2 200 A T 1|1"});
+  std::string modern2 = vcf("m2", {"2 100 A T 1|1", "1 200 A T 0|1"});
+
+  ASSERT_EQ(header +
+                "1\t100\tA\tT\t2\t1\t0\t\n"
+                "1\t200\tA\tT\t2\t0\t1\t\n",
+            merge(archaic, {modern1, modern2}));
+}
+
+TEST(SampleSubset, CanCheckSubset) {
+  std::string filename = testing::TempDir() + "vcf_merge_test_samples.txt";
+  {
+    std::ofstream sample_file(filename);
+    sample_file << "m1\nm3\n";
+  }
+  std::vector<std::string> subset = read_subset(filename);
+  std::remove(filename.c_str());
+  ASSERT_EQ(std::vector<std::string>({"m1", "m3"}), subset);
+  ASSERT_TRUE(read_subset("").empty());
+
+  std::istringstream input1(
+      "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\tm1\tm2\n");
+  std::istringstream input2(
+      "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\tm3\n");
+  std::ostringstream names;
+  std::vector<std::unique_ptr<VCF_File>> moderns;
+  moderns.emplace_back(new VCF_File(&input1, names, subset));
+  moderns.emplace_back(new VCF_File(&input2, names, subset));
+  check_subset(subset, moderns);
+
+  // an unknown sample is an error, not an empty cohort
+  subset.push_back("unknown");
+  ASSERT_THROW(check_subset(subset, moderns), std::invalid_argument);
+}
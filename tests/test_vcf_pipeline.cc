@@ -0,0 +1,151 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "IBDmix/spsc_queue.h"
+#include "IBDmix/vcf_pipeline.h"
+
+TEST(SpscQueue, CanPushAndPop) {
+  SPSC_Queue<int> queue(3);
+  ASSERT_EQ(4, queue.capacity());
+  int value = 0;
+  ASSERT_FALSE(queue.try_pop(&value));
+  for (int i = 0; i < 4; ++i) ASSERT_TRUE(queue.try_push(std::move(i)));
+  ASSERT_FALSE(queue.try_push(5));
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue.try_pop(&value));
+    ASSERT_EQ(i, value);
+  }
+  ASSERT_FALSE(queue.try_pop(&value));
+}
+
+TEST(SpscQueue, CanTransferBetweenThreads) {
+  SPSC_Queue<std::unique_ptr<int>> queue(8);
+  std::thread producer([&queue] {
+    for (int i = 0; i < 100000; ++i) {
+      std::unique_ptr<int> value(new int(i));
+      while (!queue.try_push(std::move(value))) std::this_thread::yield();
+    }
+  });
+  std::unique_ptr<int> value;
+  for (int i = 0; i < 100000; ++i) {
+    while (!queue.try_pop(&value)) std::this_thread::yield();
+    ASSERT_EQ(i, *value);
+  }
+  producer.join();
+}
+
+TEST(SpscQueue, CanBlockBetweenThreads) {
+  // the consumer pauses so the producer sleeps on a full queue, then the
+  // consumer sleeps on an empty one
+  SPSC_Queue<int> queue(2);
+  std::thread producer([&queue] {
+    for (int i = 0; i < 1000; ++i) {
+      if (i == 500) std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      queue.push(std::move(i));
+    }
+  });
+  int value = 0;
+  for (int i = 0; i < 1000; ++i) {
+    if (i == 10) std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.pop(&value);
+    ASSERT_EQ(i, value);
+  }
+  producer.join();
+}
+
+TEST(SpscQueue, CanStopWaiting) {
+  SPSC_Queue<int> queue(2);
+  std::atomic<bool> stopping(false);
+  bool popped = true;
+  std::thread consumer([&] {
+    int value;
+    popped = queue.pop(&value, stopping);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  stopping = true;
+  queue.wake();
+  consumer.join();
+  ASSERT_FALSE(popped);
+}
+
+class PipelineFile : public ::testing::Test {
+ protected:
+  void SetUp() {
+    // enough lines for several batches, with indels and missing sites
+    std::ostringstream strm;
+    strm << "#CHROM\tPOS\tID\tREF\tALT\tQUAL\tFILTER\tINFO\tFORMAT\t"
+            "I1\tI2\tI3\n";
+    for (int i = 1; i <= 3 * PIPELINE_BATCH_LINES + 7; ++i) {
+      strm << (i < 500 ? "1" : "2") << '\t' << i << "\t.\tA\t"
+           << (i % 13 == 0 ? "TT" : "T") << "\t.\tPASS\t.\tGT\t"
+           << (i % 3 == 0 ? "0|0" : "1|0") << '\t'
+           << (i % 5 == 0 ? "0|0" : "1|1") << '\t'
+           << (i % 7 == 0 ? "0|0" : ".|.") << '\n';
+    }
+    contents = strm.str();
+  }
+
+  std::string contents;
+};
+
+TEST_F(PipelineFile, MatchesVcfFile) {
+  for (bool skip : {false, true}) {
+    std::istringstream expected_input(contents), pipelined_input(contents);
+    std::ostringstream names;
+    VCF_File expected(&expected_input, names);
+    VCF_File file(&pipelined_input, names);
+    Pipelined_VCF_File pipelined(&file, skip);
+    ASSERT_EQ(expected.getBlank(), pipelined.getBlank());
+    ASSERT_EQ(expected.getCount(), pipelined.getCount());
+
+    while (expected.update(skip)) {
+      ASSERT_TRUE(pipelined.update());
+      ASSERT_EQ(expected.getChromosome(), pipelined.getChromosome());
+      ASSERT_EQ(expected.getPosition(), pipelined.getPosition());
+      ASSERT_EQ(expected.isValid(), pipelined.isValid());
+      if (!expected.isValid()) continue;
+      ASSERT_EQ(expected.getReference(), pipelined.getReference());
+      ASSERT_EQ(expected.getAlternative(), pipelined.getAlternative());
+      ASSERT_EQ(expected.getGenotypes(), pipelined.getGenotypes());
+    }
+    ASSERT_FALSE(pipelined.update());
+    ASSERT_FALSE(pipelined.update());
+  }
+}
+
+TEST_F(PipelineFile, CanStopEarly) {
+  // the reader thread is blocked on a full queue when destroyed
+  std::istringstream input(contents + contents + contents);
+  std::ostringstream names;
+  VCF_File file(&input, names);
+  Pipelined_VCF_File pipelined(&file);
+  ASSERT_TRUE(pipelined.update());
+  ASSERT_EQ(1, pipelined.getPosition());
+}
+
+TEST(PipelineWriter, MatchesWriter) {
+  std::vector<std::string> samples = {"n1", "m1", "m2"};
+  std::ostringstream expected_output, pipelined_output;
+  Text_Genotype_Writer expected(expected_output, samples);
+  Text_Genotype_Writer writer(pipelined_output, samples);
+  Pipelined_Genotype_Writer pipelined(&writer);
+
+  expected.writeHeader();
+  pipelined.writeHeader();
+  std::string archaic = "1\t", modern = "0\t2\t";
+  for (int i = 0; i < 2 * PIPELINE_BATCH_LINES * PIPELINE_BATCHES + 3; ++i) {
+    archaic[0] = '0' + i % 3;
+    expected.writeSite("1", i, 'A', 'T', archaic, modern);
+    pipelined.writeSite("1", i, 'A', 'T', archaic, modern);
+  }
+  pipelined.finish();
+  expected.flush();
+  ASSERT_EQ(expected_output.str(), pipelined_output.str());
+}